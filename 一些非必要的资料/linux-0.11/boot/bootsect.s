@@ -21,6 +21,10 @@ SYSSIZE = 0x3000 ;编译连接后的system 模块大小，这里直接设置一
 ; The loader has been made as simple as possible, and continuos
 ; read errors will result in a unbreakable loop. Reboot by hand. It
 ; loads pretty fast by getting whole sectors at a time whenever possible.
+;
+; If the BIOS supports the int 0x13 extensions for the boot drive, the
+; system is read with LBA packet reads of 64 sectors (32kB) at a time
+; instead of track by track.
 
 .globl begtext, begdata, begbss, endtext, enddata, endbss  ;定义全局标志符
 .text  ;定义文本数据段
@@ -66,6 +70,14 @@ go:	mov	ax,cs 	;ds、es、ss、 都设置成移动后的地址(0x9000)
 	mov	ss,ax ; 设置栈段为0x9000
 	mov	sp,#0xFF00		; 将栈顶部指针指向0xFF00 远远大于0x9000的地方 arbitrary value >>512
 
+; BIOS 把引导驱动器号放在 dl 中，之后的读盘都使用它(软盘 0，硬盘 0x80)
+; 再记下此刻的 BIOS 时钟滴答数(int 0x1a，ah = 0，返回 cx:dx)，内核用它计算引导耗时
+	mov	drive,dl
+	xor	ah,ah
+	int	0x1a
+	mov	boot_ticks,dx
+	mov	boot_ticks+2,cx
+
 
 
 
@@ -83,13 +95,14 @@ go:	mov	ax,cs 	;ds、es、ss、 都设置成移动后的地址(0x9000)
 ; s:bx -> 指向数据缓冲区；  如果出错则 CF 标志置位。
 
 load_setup:
-	mov	dx,#0x0000		; drive 0, head 0 ;dx 数据寄存器设置为0
+	mov	dh,#0x00		; head 0
+	mov	dl,drive		; boot drive
 	mov	cx,#0x0002		; sector 2, track 0;cx 程序计数器设置为2,表示重复两次
 	mov	bx,#0x0200		; address = 512, in INITSEG 设置指定定制为 0x0200
 	mov	ax,#0x0200+SETUPLEN	; service 2, nr of sectors  设置地址为扇区 0x0200 + 扇区数量
 	int	0x13			; read it 调用0x13 中断
 	jnc	ok_load_setup		; ok - continue ;调用成功继续执行
-	mov	dx,#0x0000 ; 调用失败重新开始
+	mov	dl,drive ; 调用失败重新开始
 	mov	ax,#0x0000		; reset the diskette
 	int	0x13
 	j	load_setup
@@ -100,7 +113,7 @@ ok_load_setup:
 ; 系统调用成功后，读取磁盘驱动器的参数，包含每道扇区的数量
 ; 进行相关设备的加载和读取
 
-	mov	dl,#0x00 ; 将dl 设置为0--驱动器号
+	mov	dl,drive ; 驱动器号
 	mov	ax,#0x0800		; AH=8 is get drive parameters， 磁盘驱动参数
 ;返回信息：
 ;如果出错则 CF 置位，并且 ah = 状态码。    
@@ -116,6 +129,20 @@ ok_load_setup:
 	mov	ax,#INITSEG ; 设置ax为 0x9000
 	mov	es,ax ; 设置es为0x9000
 
+; Check for the int 0x13 extensions (ah=0x41): bx=0xaa55 on return and
+; bit 0 of cx set means the packet interface (ah=0x42) can be used.
+; 检查 BIOS 是否支持 int 0x13 扩展读(LBA)，支持时置 lba = 1
+	mov	ah,#0x41
+	mov	bx,#0x55aa
+	mov	dl,drive
+	int	0x13
+	jc	no_lba
+	cmp	bx,#0xaa55
+	jne	no_lba
+	and	cx,#1
+	mov	lba,cx
+no_lba:
+
 ; Print some inane message
 ; 答应相关的磁盘信息
 	mov	ah,#0x03		; read cursor pos
@@ -207,10 +234,18 @@ rp_read:
 ; 判断是否已经读入全部数据。比较当前所读段是否就是系统数据末端所处的段(#ENDSEG)，如果不是就  
 ; 跳转至下面 ok1_read 标号处继续读数据。否则退出子程序返回。
 	mov ax,es
-	cmp ax,#ENDSEG		; have we loaded all yet?
+	cmp ax,endseg		; have we loaded all yet?
 	jb ok1_read ; 不是就跳转至ok1_read 继续读取
 	ret ; 否则进行返回
 ok1_read:
+; 支持扩展读时每次读 64 个扇区(32KB)，es:bx 总是 32KB 对齐，不会跨越 64KB 边界
+	mov ax,lba
+	or ax,ax
+	jz chs_read
+	call read_lba
+	mov cx,#0x8000 ; 本次读入的字节数
+	jmp next_read
+chs_read:
 ; 计算和验证当前磁道需要读取的扇区数，放在 ax 寄存器中。    
 ; 根据当前磁道还未读取的扇区数以及段内数据字节开始偏移位置，计算如果全部读取这些未读扇区，    
 ; 所读总字节数是否会超过 64KB 段长度的限制。若会超过，则根据此次最多能读入的字节数(64KB – 段内 
@@ -244,6 +279,7 @@ ok4_read:
 ok3_read:
 	mov sread,ax ; 保存当前已经读取的大小
 	shl cx,#9    ; 计算已经读取大小 = cx(已经读取扇区数量) * 512(扇区大小)
+next_read:
 	add bx,cx    ; 设置数据段开始位置
 	jnc rp_read	 ; 如果还是没有全部读取
 	mov ax,es    ; 继续执行读取操作
@@ -271,7 +307,7 @@ read_track:
 	mov ch,dl    ; ch 设置为当前的磁道号
 	mov dx,head  ; dx 为当前的磁头号
 	mov dh,dl    ; dh = 磁头号
-	mov dl,#0    ; dl = 驱动器号(为 0 表示当前 A 驱动器)。
+	mov dl,drive ; dl = 引导驱动器号
 	and dx,#0x0100 ; 磁头号不大于 1。 
 	mov ah,#2    ; ah = 2，读磁盘扇区功能号。 
 	int 0x13     ; 中断信号进行磁盘数据读取
@@ -286,7 +322,7 @@ read_track:
 
 ; 执行驱动器复位操作（磁盘中断功能号 0），再跳转到 read_track 处重试。
 bad_rt:	mov ax,#0
-	mov dx,#0
+	mov dl,drive
 	int 0x13
 	pop dx
 	pop cx
@@ -295,6 +331,40 @@ bad_rt:	mov ax,#0
 	jmp read_track
 
 
+; 用扩展读(int 0x13，ah = 0x42)把从 dap_lba 开始的 64 个扇区读到 es:bx，
+; 成功后 dap_lba 加 64。出错则复位驱动器后重试。
+; ds:si 指向磁盘地址包(dap)。
+
+read_lba:
+	push ax
+	push dx
+	push si
+	mov ax,#64
+	mov dap_count,ax ; 出错时 BIOS 会改写扇区数，每次都重新设置
+	mov dap_off,bx
+	mov dap_seg,es
+	mov si,#dap
+	mov dl,drive
+	mov ah,#0x42
+	int 0x13
+	jc bad_lba
+	mov ax,dap_lba
+	add ax,#64
+	mov dap_lba,ax
+	pop si
+	pop dx
+	pop ax
+	ret
+
+bad_lba:
+	mov ax,#0
+	mov dl,drive
+	int 0x13
+	pop si
+	pop dx
+	pop ax
+	jmp read_lba
+
 ; read_it ====== end
 
 /*
@@ -316,13 +386,34 @@ kill_motor:
 
 sectors:
 	.word 0
+drive:
+	.byte 0		; 引导驱动器号
+lba:
+	.word 0		; 1 - 使用扩展读
+
+; disk address packet for int 0x13, ah=0x42
+; 扩展读的磁盘地址包：包长度、保留、扇区数、缓冲区偏移、段、64 位起始 LBA
+dap:
+	.byte 0x10,0
+dap_count:
+	.word 64
+dap_off:
+	.word 0
+dap_seg:
+	.word 0
+dap_lba:
+	.word 1+SETUPLEN,0,0,0	; system 紧跟在引导扇区和 setup 之后
 
 msg1:
 	.byte 13,10
 	.ascii "Loading system ..."
 	.byte 13,10,13,10
 
-.org 508
+.org 502
+endseg:
+	.word ENDSEG	; build 按 system 的实际大小改写，setup 从 0x901F6 取
+boot_ticks:
+	.word 0,0	; bootsect 开始执行时的 BIOS 时钟滴答数，内核从 0x901F8 取
 root_dev:
 	.word ROOT_DEV
 boot_flag:
@@ -38,6 +38,17 @@ startup_32: ; 18-22 行设置各个数据段寄存器
 	mov %ax,%es
 	mov %ax,%fs
 	mov %ax,%gs
+# The system image doesn't contain the bss, and nothing below guarantees
+# the memory after it is zero (setup.s only moves what was loaded), so
+# clear it here, before the stack in it (user_stack) is used.
+# 清零 bss：映像中不包含 bss，其所在内存的内容不确定。必须在使用其中的栈之前进行
+	cld
+	movl $_edata,%edi
+	movl $_end,%ecx
+	subl %edi,%ecx
+	xorl %eax,%eax
+	rep
+	stosb
 	lss _stack_start,%esp ; 表示 _stack_start -> ss:esp 设置系统堆栈 stack_start 定义在 kernel/sched.c，69 行。 
 	call setup_idt       ; 设置中断描述符表，调用set_up idt 程序
 	call setup_gdt		; 设置全局描述符表子程序
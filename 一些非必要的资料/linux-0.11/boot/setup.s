@@ -147,6 +147,18 @@ no_disk1:
 	stosb ; 将ax的值0x00 填充到目标地址，相当于进行清空 
 is_disk1:
 
+; Save the BIOS tick count (int 0x1a, ah=0) at 0x901F0: together with the
+; one bootsect saved at 0x901F8 it tells main() how long loading took.
+; 记下加载结束时的 BIOS 时钟滴答数(cx:dx)，main() 用它和 bootsect 记下的值计算引导耗时
+
+	mov	ax,#INITSEG
+	mov	ds,ax
+	xor	ah,ah
+	int	0x1a
+	mov	[0x1f0],dx
+	mov	[0x1f2],cx
+	mov	bx,[0x1f6]	; bootsect 的 endseg：已加载 system 的末端段
+
 ; now we want to move to protected mode ...
 ; 进入保护模式开始执行
 
@@ -155,18 +167,24 @@ is_disk1:
 ; first we move the system to it's rightful place
 ; 首先我们将system 模块移动到正确的位置0x00000处
 ; 现在system的位置是0x10000 ~ 0x8fff 需要将内存向低端移动0x10000(64K)的位置
+; Only the part bootsect actually loaded (up to endseg) is moved, a dword
+; at a time. It can't be loaded at 0 directly: the BIOS still needs its
+; interrupt vectors and data area there while bootsect reads the disk.
+; 只移动 bootsect 实际加载的部分(到 endseg 为止)，并且每次移动 4 字节。
+; 不能直接加载到 0 处：读盘期间 BIOS 还要用那里的中断向量表和数据区
 
 	mov	ax,#0x0000
 	cld			; 'direction'=0, movs moves forward
 do_move:  ; 开始执行搬迁
 	mov	es,ax		; destination segment
 	add	ax,#0x1000 ;设置源地址为 0x1000
-	cmp	ax,#0x9000 ; 确定指向地址超过0x9000--已经搬迁完毕
-	jz	end_move  ; 结束移动
+	cmp	ax,bx ; 已经到达已加载 system 的末端--已经搬迁完毕
+	jae	end_move  ; 结束移动
 	mov	ds,ax		; source segment 设置段起开始地址
 	sub	di,di 
 	sub	si,si
-	mov 	cx,#0x8000  ;设置数据大小
+	mov 	cx,#0x4000  ;设置数据大小(双字数)
+	.byte	0x66		; operand size prefix: movsw -> movsd
 	rep
 	movsw           ;执行移动
 	jmp	do_move    ; 没有移动完，继续执行
@@ -0,0 +1,65 @@
+/*
+ *  linux/boot/unzip.c
+ */
+
+/*
+ * 压缩内核的解压部分，由 boot/zhead.s 在 1MB 处调用。
+ * 压缩数据 input_data 由 tools/rdzip -s 生成(boot/zpiggy.s)，格式与压缩虚拟盘
+ * 相同：struct rdz_header 之后是 LZSS 数据流(include/linux/lzss.h)。
+ * 这时还没有 printk，出错只能在屏幕左上角显示一行字后停机。
+ */
+
+#include <linux/lzss.h>
+
+/*
+ * setup.s 把系统参数放在 0x90000 处，不能覆盖。这里只能检查 text+data；
+ * bss(head.s 会清零)也不能到达那里，由 tools/rdzip -s 在生成 zImage 时检查
+ */
+#define SYS_MAX	0x90000
+
+extern unsigned char input_data[];
+
+static unsigned char * inptr = input_data;
+static unsigned char * inend = input_data;
+
+/**
+ * @brief  lzss_decode() 的取字节函数
+ * @return int              下一个字节，数据已读完时返回 -1
+ */
+static int getb(void)
+{
+	if (inptr >= inend)
+		return -1;
+	return *inptr++;
+}
+
+/**
+ * @brief  在屏幕左上角显示出错信息并停机
+ * @param  s                出错信息
+ */
+static void error(char * s)
+{
+	unsigned short * vga = (unsigned short *) 0xb8000;
+
+	while (*s)
+		*vga++ = 0x0700 | (unsigned char) *s++;
+	for (;;)
+		/* nothing */ ;
+}
+
+/**
+ * @brief  把 system 解压到物理地址 0 处
+ */
+void decompress_kernel(void)
+{
+	struct rdz_header * h = (struct rdz_header *) input_data;
+
+	if (h->magic != RDZ_MAGIC)
+		error("Bad compressed kernel");
+	if (h->size > SYS_MAX)
+		error("Kernel too big");
+	inptr = input_data + sizeof(struct rdz_header);
+	inend = inptr + h->zsize;
+	if (lzss_decode((char *) 0, h->size, getb) != h->size)
+		error("Corrupt compressed kernel");
+}
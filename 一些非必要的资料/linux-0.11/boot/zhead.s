@@ -0,0 +1,47 @@
+/*
+ *  linux/boot/zhead.s
+ */
+
+/*
+ * zhead.s is the 32-bit entry of a compressed kernel (zImage). setup.s
+ * moves it to 0 and jumps there just as it does with the plain system.
+ * It is linked to run at ZHIGH (1MB, see -Ttext in the Makefile), so it
+ * first copies itself and the compressed data up there. Then it
+ * decompresses the system to 0 (boot/unzip.c) and jumps to its head.s,
+ * which sets up paging etc as usual.
+ *
+ * Until the ljmp below only absolute constants may be used: the code
+ * runs at 0, but every address the linker filled in is one at ZHIGH.
+ */
+
+/*
+ * 压缩内核(zImage)的 32 位入口。setup.s 像对待普通 system 一样把它移到 0 处
+ * 并跳转过来。它被连接在 1MB 处运行，因此先把自己连同压缩数据复制到 1MB，
+ * 再把 system 解压到 0 处(boot/unzip.c)，最后跳到解压出的 head.s。
+ */
+.text
+.globl startup_32
+startup_32:
+	cld
+	movl $0x10,%eax		# setup.s 中的数据段
+	mov %ax,%ds
+	mov %ax,%es
+	mov %ax,%fs
+	mov %ax,%gs
+	mov %ax,%ss
+	xorl %esi,%esi		# 当前在 0 处 ...
+	movl $startup_32,%edi	# ... 复制到连接地址
+	movl $_edata,%ecx
+	subl %edi,%ecx
+	rep
+	movsb
+	ljmp $8,$1f		# 转到高处的副本继续执行
+1:	movl $_end+4096,%esp	# 栈放在 bss 之后
+	movl $_edata,%edi	# 清 bss
+	movl $_end,%ecx
+	subl %edi,%ecx
+	xorl %eax,%eax
+	rep
+	stosb
+	call _decompress_kernel
+	ljmp $8,$0		# 进入解压出的 head.s
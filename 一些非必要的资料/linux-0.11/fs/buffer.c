@@ -54,6 +54,7 @@
 #include <linux/config.h>
 #include <linux/sched.h>
 #include <linux/kernel.h>
+#include <linux/trace.h>
 #include <asm/system.h>
 #include <asm/io.h>
 /**
@@ -75,7 +76,7 @@ static struct buffer_head * free_list;
 /**
  * @brief 等待缓冲区
  */
-static struct task_struct * buffer_wait = NULL;
+static struct wait_queue * buffer_wait = NULL;
 int NR_BUFFERS = 0;
 /**
  * @brief 等待指定缓冲区解锁
@@ -299,6 +300,9 @@ struct buffer_head * get_hash_table(int dev, int block)
 {
 	struct buffer_head * bh;
 
+	// 虚拟盘的块直接映射在虚拟盘内存上，不占用高速缓冲区
+	if (MAJOR(dev) == 1 && (bh = rd_getblk(dev,block)))
+		return bh;
 	for (;;) {
         // 查找buffer
 		if (!(bh=find_buffer(dev,block)))
@@ -360,7 +364,7 @@ repeat:
     // 还是没有找到
     // 进程等待，下次再来
 	if (!bh) {
-		sleep_on(&buffer_wait);
+		sleep_on_exclusive(&buffer_wait);
 		goto repeat;
 	}
 	wait_on_buffer(bh);
@@ -431,6 +435,7 @@ struct buffer_head * bread(int dev,int block)
     // 查询blk数据块
 	if (!(bh=getblk(dev,block)))
 		panic("bread: getblk returned NULL\n");
+	trace(bh->b_uptodate ? TRACE_BUF_HIT : TRACE_BUF_MISS, dev, block);
 	if (bh->b_uptodate)
 		return bh;
     // 读取对应数据块
@@ -478,10 +483,13 @@ void bread_page(unsigned long address,int dev,int b[4])
 	for (i=0 ; i<4 ; i++){
 		if (b[i]) {
             // 查询对应高速缓冲块
-			if (bh[i] = getblk(dev,b[i]))
+			if (bh[i] = getblk(dev,b[i])) {
+				trace(bh[i]->b_uptodate ? TRACE_BUF_HIT : TRACE_BUF_MISS,
+					dev, b[i]);
 				if (!bh[i]->b_uptodate)
                     // 进行读写操作
 					ll_rw_block(READ,bh[i]);
+			}
 		} else {
 			bh[i] = NULL;
         }
@@ -521,6 +529,7 @@ struct buffer_head * breada(int dev,int first, ...)
     // 查询高速缓冲块
 	if (!(bh=getblk(dev,first)))
 		panic("bread: getblk returned NULL\n");
+	trace(bh->b_uptodate ? TRACE_BUF_HIT : TRACE_BUF_MISS, dev, first);
 	// 没有读取
     if (!bh->b_uptodate) {
         // 进行读取
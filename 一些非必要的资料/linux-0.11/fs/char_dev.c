@@ -5,10 +5,12 @@
  */
 
 #include <errno.h>
+#include <fcntl.h>
 #include <sys/types.h>
 
 #include <linux/sched.h>
 #include <linux/kernel.h>
+#include <linux/trace.h>
 
 #include <asm/segment.h>
 #include <asm/io.h>
@@ -21,19 +23,33 @@
  */
 extern int tty_read(unsigned minor,char * buf,int count);
 extern int tty_write(unsigned minor,char * buf,int count);
+extern int tty_ready(unsigned minor,int rw);
 
-typedef (*crw_ptr)(int rw,unsigned minor,char * buf,int count,off_t * pos);
+typedef (*crw_ptr)(int rw,unsigned minor,char * buf,int count,off_t * pos,
+	unsigned short flags);
 /**
  * @brief  终端读写操作
+ * O_NONBLOCK 时先查询终端队列：读时只取已有的字符，写时只写入队列放得下的部分，
+ * 这样 tty_read()/tty_write() 就不会睡眠；一个字符也处理不了则返回 -EAGAIN
  * @param  rw               读写操作描述符
  * @param  minor            对应设备
  * @param  buf              缓冲指针
  * @param  count            数据长度
  * @param  pos              起始位置
+ * @param  flags            文件打开标志
  * @return int              最终结果
  */
-static int rw_ttyx(int rw,unsigned minor,char * buf,int count,off_t * pos)
+static int rw_ttyx(int rw,unsigned minor,char * buf,int count,off_t * pos,
+	unsigned short flags)
 {
+	int n;
+
+	if (flags & O_NONBLOCK) {
+		if (!(n = tty_ready(minor,rw)))
+			return -EAGAIN;
+		if (count > n)
+			count = n;
+	}
 	return ((rw==READ)?tty_read(minor,buf,count):
 		tty_write(minor,buf,count));
 }
@@ -46,11 +62,12 @@ static int rw_ttyx(int rw,unsigned minor,char * buf,int count,off_t * pos)
  * @param  pos              My Param doc
  * @return int 
  */
-static int rw_tty(int rw,unsigned minor,char * buf,int count, off_t * pos)
+static int rw_tty(int rw,unsigned minor,char * buf,int count, off_t * pos,
+	unsigned short flags)
 {
 	if (current->tty<0)
 		return -EPERM;
-	return rw_ttyx(rw,current->tty,buf,count,pos);
+	return rw_ttyx(rw,current->tty,buf,count,pos,flags);
 }
 
 static int rw_ram(int rw,char * buf, int count, off_t *pos)
@@ -84,7 +101,8 @@ static int rw_port(int rw,char * buf, int count, off_t * pos)
 	return i;
 }
 // 内存读写操作函数
-static int rw_memory(int rw, unsigned minor, char * buf, int count, off_t * pos)
+static int rw_memory(int rw, unsigned minor, char * buf, int count, off_t * pos,
+	unsigned short flags)
 {
 	switch(minor) {
 		case 0:
@@ -97,6 +115,8 @@ static int rw_memory(int rw, unsigned minor, char * buf, int count, off_t * pos)
 			return (rw==READ)?0:count;	/* rw_null */
 		case 4:
 			return rw_port(rw,buf,count,pos);
+		case 5:
+			return rw_trace(rw,buf,count);	/* /dev/trace */
 		default:
 			return -EIO;
 	}
@@ -114,7 +134,8 @@ static crw_ptr crw_table[]={
 	NULL,		/* /dev/lp */
 	NULL};		/* unnamed pipes */
 
-int rw_char(int rw,int dev, char * buf, int count, off_t * pos)
+int rw_char(int rw,int dev, char * buf, int count, off_t * pos,
+	unsigned short flags)
 {
 	crw_ptr call_addr;
 
@@ -123,5 +144,5 @@ int rw_char(int rw,int dev, char * buf, int count, off_t * pos)
 	if (!(call_addr=crw_table[MAJOR(dev)]))
 		return -ENODEV;
     // 调用对应函数
-	return call_addr(rw,MINOR(dev),buf,count,pos);
+	return call_addr(rw,MINOR(dev),buf,count,pos,flags);
 }
@@ -437,6 +437,9 @@ restart_interp:
 	if (last_task_used_math == current)
 		last_task_used_math = NULL;
 	current->used_math = 0;
+	// 计数缓冲区属于原来的程序，停止剖析
+	current->prof_scale = 0;
+	current->prof_ticks = 0;
 	// 根据text修改局部表中描述符基址和段限长，并将参数和环境空间页面放置在数据段末端
 	p += change_ldt(ex.a_text,page)-MAX_ARG_PAGES*PAGE_SIZE;
 	p = (unsigned long) create_tables((char *)p,argc,envc);
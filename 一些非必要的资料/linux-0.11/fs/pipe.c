@@ -5,6 +5,8 @@
  */
 
 #include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
 
 #include <linux/sched.h>
 #include <linux/mm.h>	/* for get_free_page */
@@ -12,11 +14,12 @@
 /**
  * @brief  进行管道文件的读写操作
  * @param  inode            目标inode节点
+ * @param  filp             文件结构指针，O_NONBLOCK 时管道空不睡眠
  * @param  buf              对应的目标缓冲buffer
  * @param  count            数据长度描述
  * @return int              最终读取的字节长度
  */
-int read_pipe(struct m_inode * inode, char * buf, int count)
+int read_pipe(struct m_inode * inode, struct file * filp, char * buf, int count)
 {
 	int chars, size, read = 0;
 
@@ -27,6 +30,9 @@ int read_pipe(struct m_inode * inode, char * buf, int count)
 			wake_up(&inode->i_wait);
 			if (inode->i_count != 2) /* are there any writers? */
 				return read;
+			// 非阻塞方式：已读到数据就返回，否则返回 -EAGAIN
+			if (filp->f_flags & O_NONBLOCK)
+				return read?read:-EAGAIN;
 			sleep_on(&inode->i_wait);
 		}
         // 检查是否需要分页
@@ -54,11 +60,12 @@ int read_pipe(struct m_inode * inode, char * buf, int count)
  * @brief  管道写入函数
  * 基本和读取函数一致，不过转换为了写入
  * @param  inode            对应的inode 数据节点
+ * @param  filp             文件结构指针，O_NONBLOCK 时管道满不睡眠
  * @param  buf              目标缓冲区buf
  * @param  count            目标数据长度
  * @return int              最终返回结果
  */
-int write_pipe(struct m_inode * inode, char * buf, int count)
+int write_pipe(struct m_inode * inode, struct file * filp, char * buf, int count)
 {
 	int chars, size, written = 0;
 
@@ -69,6 +76,8 @@ int write_pipe(struct m_inode * inode, char * buf, int count)
 				current->signal |= (1<<(SIGPIPE-1));
 				return written?written:-1;
 			}
+			if (filp->f_flags & O_NONBLOCK)
+				return written?written:-EAGAIN;
 			sleep_on(&inode->i_wait);
 		}
 		chars = PAGE_SIZE-PIPE_HEAD(*inode);
@@ -12,9 +12,12 @@
 #include <linux/sched.h>
 #include <asm/segment.h>
 
-extern int rw_char(int rw,int dev, char * buf, int count, off_t * pos);
-extern int read_pipe(struct m_inode * inode, char * buf, int count);
-extern int write_pipe(struct m_inode * inode, char * buf, int count);
+extern int rw_char(int rw,int dev, char * buf, int count, off_t * pos,
+		unsigned short flags);
+extern int read_pipe(struct m_inode * inode, struct file * filp,
+		char * buf, int count);
+extern int write_pipe(struct m_inode * inode, struct file * filp,
+		char * buf, int count);
 extern int block_read(int dev, off_t * pos, char * buf, int count);
 extern int block_write(int dev, off_t * pos, char * buf, int count);
 extern int file_read(struct m_inode * inode, struct file * filp,
@@ -82,9 +85,10 @@ int sys_read(unsigned int fd,char * buf,int count)
 	inode = file->f_inode;
     // 这里就是简单的if else 的策略工厂模式了
 	if (inode->i_pipe)
-		return (file->f_mode&1)?read_pipe(inode,buf,count):-EIO;
+		return (file->f_mode&1)?read_pipe(inode,file,buf,count):-EIO;
 	if (S_ISCHR(inode->i_mode))
-		return rw_char(READ,inode->i_zone[0],buf,count,&file->f_pos);
+		return rw_char(READ,inode->i_zone[0],buf,count,&file->f_pos,
+			file->f_flags);
 	if (S_ISBLK(inode->i_mode))
 		return block_read(inode->i_zone[0],&file->f_pos,buf,count);
     // 如果为目录或者文件
@@ -118,9 +122,10 @@ int sys_write(unsigned int fd,char * buf,int count)
 		return 0;
 	inode=file->f_inode;
 	if (inode->i_pipe)
-		return (file->f_mode&2)?write_pipe(inode,buf,count):-EIO;
+		return (file->f_mode&2)?write_pipe(inode,file,buf,count):-EIO;
 	if (S_ISCHR(inode->i_mode))
-		return rw_char(WRITE,inode->i_zone[0],buf,count,&file->f_pos);
+		return rw_char(WRITE,inode->i_zone[0],buf,count,&file->f_pos,
+			file->f_flags);
 	if (S_ISBLK(inode->i_mode))
 		return block_write(inode->i_zone[0],&file->f_pos,buf,count);
 	if (S_ISREG(inode->i_mode))
@@ -0,0 +1,339 @@
+/*
+ *  linux/fs/select.c
+ */
+
+/*
+ * This file contains the procedures for the handling of select and poll.
+ *
+ * A task waits on several objects at once by linking one wait queue
+ * entry per object (add_wait) and unlinking all of them (free_wait)
+ * before it returns to the user.
+ */
+
+/*
+ * 本文件实现 select() 和 poll() 系统调用。
+ *
+ * 进程为每个被等待对象(管道 i 节点、终端队列)准备一个等待队列项并链入
+ * 该对象的等待队列(add_wait)，返回用户态之前全部摘除(free_wait)。
+ */
+
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/poll.h>
+
+#include <linux/sched.h>
+#include <linux/kernel.h>
+#include <linux/tty.h>
+
+#include <asm/segment.h>
+#include <asm/system.h>
+
+/**
+ * @brief 一个等待点：等待队列项以及它所在队列的地址
+ */
+typedef struct {
+	struct wait_queue wait;
+	struct wait_queue ** wait_address;
+} wait_entry;
+
+/**
+ * @brief 一次 select 调用用到的全部等待点，每个文件最多读、写各一个
+ */
+typedef struct {
+	int nr;
+	wait_entry entry[NR_OPEN*2];
+} select_table;
+
+/**
+ * @brief  把当前进程挂到等待队列 *wait_address 上
+ * 同一队列只挂一次(管道的读写两端共用 i_wait)
+ * @param  wait_address     等待队列头指针地址
+ * @param  p                本次 select 的等待表
+ */
+static void add_wait(struct wait_queue ** wait_address, select_table * p)
+{
+	int i;
+
+	if (!wait_address)
+		return;
+	for (i = 0 ; i < p->nr ; i++)
+		if (p->entry[i].wait_address == wait_address)
+			return;
+	p->entry[p->nr].wait_address = wait_address;
+	p->entry[p->nr].wait.task = current;
+	p->entry[p->nr].wait.flags = 0;
+	add_wait_queue(wait_address, &p->entry[p->nr].wait);
+	p->nr++;
+}
+
+/**
+ * @brief  把当前进程从所有等待队列上摘下
+ * @param  p                本次 select 的等待表
+ */
+static void free_wait(select_table * p)
+{
+	int i;
+
+	for (i = 0; i < p->nr ; i++)
+		remove_wait_queue(p->entry[i].wait_address, &p->entry[i].wait);
+	p->nr = 0;
+}
+
+/**
+ * @brief  取得字符设备 i 节点对应的终端号
+ * @param  inode            i 节点
+ * @return int              终端号(0-2)，不是终端返回 -1
+ */
+static int tty_channel(struct m_inode * inode)
+{
+	int dev;
+
+	if (!S_ISCHR(inode->i_mode))
+		return -1;
+	dev = inode->i_zone[0];
+	if (MAJOR(dev) == 5)
+		dev = current->tty;
+	else if (MAJOR(dev) == 4)
+		dev = MINOR(dev);
+	else
+		return -1;
+	return (dev >= 0 && dev <= 2) ? dev : -1;
+}
+
+/**
+ * @brief  检查文件是否可以不睡眠地读(READ)或写(WRITE)
+ * 不就绪时把当前进程挂到该对象的等待指针上
+ * @param  rw               READ 或 WRITE
+ * @param  inode            文件 i 节点
+ * @param  wait             等待表
+ * @return int              1 - 就绪，0 - 未就绪
+ */
+static int check(int rw, struct m_inode * inode, select_table * wait)
+{
+	int channel;
+
+	if (inode->i_pipe) {
+		// 另一端已关闭：读会立即得到 EOF，写会立即得到 SIGPIPE
+		if (inode->i_count != 2)
+			return 1;
+		if ((rw == READ) ? !PIPE_EMPTY(*inode) : !PIPE_FULL(*inode))
+			return 1;
+		add_wait(&inode->i_wait, wait);
+		return 0;
+	}
+	if ((channel = tty_channel(inode)) >= 0) {
+		if (tty_ready(channel, rw))
+			return 1;
+		add_wait((rw == READ) ? &tty_table[channel].secondary.proc_list :
+			&tty_table[channel].write_q.proc_list, wait);
+		return 0;
+	}
+	// 普通文件、块设备及其它字符设备的读写都不会无限期等待
+	return 1;
+}
+
+/**
+ * @brief  select()/poll() 的公共部分
+ * 调用前由调用者设置 current->timeout；forever 为真表示没有超时
+ * @param  in               要检查可读的文件位图
+ * @param  out              要检查可写的文件位图
+ * @param  inp              返回可读的文件位图
+ * @param  outp             返回可写的文件位图
+ * @param  forever          是否无限期等待
+ * @return int              就绪的数目，出错返回负的错误码
+ */
+static int do_select(fd_set in, fd_set out, fd_set * inp, fd_set * outp,
+	int forever)
+{
+	select_table wait_table;
+	struct file * filp;
+	fd_set mask;
+	int i, count;
+
+	mask = in | out;
+	for (i = 0 ; i < NR_OPEN ; i++, mask >>= 1) {
+		if (!(mask & 1))
+			continue;
+		if (!(filp = current->filp[i]) || !filp->f_inode)
+			return -EBADF;
+	}
+	wait_table.nr = 0;
+repeat:
+	// 先置为可中断睡眠再检查，检查之后发生的唤醒会把状态改回运行，不会丢失
+	current->state = TASK_INTERRUPTIBLE;
+	*inp = *outp = 0;
+	count = 0;
+	mask = 1;
+	for (i = 0 ; i < NR_OPEN ; i++, mask += mask) {
+		if ((mask & in) && check(READ, current->filp[i]->f_inode, &wait_table)) {
+			*inp |= mask;
+			count++;
+		}
+		if ((mask & out) && check(WRITE, current->filp[i]->f_inode, &wait_table)) {
+			*outp |= mask;
+			count++;
+		}
+	}
+	if (!count && !(current->signal & ~current->blocked) &&
+	    (forever || current->timeout)) {
+		schedule();
+		free_wait(&wait_table);
+		goto repeat;
+	}
+	current->state = TASK_RUNNING;
+	free_wait(&wait_table);
+	return count;
+}
+
+/**
+ * @brief  把超时时间换算成滴答数，不足一个滴答的向上取整
+ */
+#define USEC_TO_TICKS(usec) (((usec) + (1000000/HZ) - 1) / (1000000/HZ))
+#define MSEC_TO_TICKS(msec) (((msec) + (1000/HZ) - 1) / (1000/HZ))
+
+/**
+ * @brief 超时的上限(滴答)。schedule() 用有符号的差比较 timeout 和 jiffies，
+ * 更长的超时会被当成已经到期
+ */
+#define MAX_TIMEOUT 0x3fffffffUL
+
+/**
+ * @brief  select 系统调用
+ * 参数超过 3 个，由库函数把它们按顺序放在用户栈上并传入首地址：
+ * buffer[0] - 位图宽度，[1] - 读位图，[2] - 写位图，[3] - 异常位图，[4] - 超时
+ * 没有对象会产生异常条件，异常位图总是返回空
+ * @param  buffer           参数块地址
+ * @return int              就绪的文件数
+ */
+int sys_select(unsigned long * buffer)
+{
+	int i, width, forever;
+	fd_set res_in, in = 0, *inp;
+	fd_set res_out, out = 0, *outp;
+	fd_set *exp, mask;
+	struct timeval *tvp;
+	unsigned long timeout;
+
+	width = get_fs_long(buffer);
+	inp = (fd_set *) get_fs_long(buffer+1);
+	outp = (fd_set *) get_fs_long(buffer+2);
+	exp = (fd_set *) get_fs_long(buffer+3);
+	tvp = (struct timeval *) get_fs_long(buffer+4);
+	if (width < 0)
+		return -EINVAL;
+	mask = (width >= NR_OPEN) ? ~0UL : ((1UL << width) - 1);
+	if (inp)
+		in = mask & get_fs_long(inp);
+	if (outp)
+		out = mask & get_fs_long(outp);
+	forever = !tvp;
+	current->timeout = 0;
+	if (tvp) {
+		timeout = get_fs_long((unsigned long *)&tvp->tv_sec);
+		if (timeout >= MAX_TIMEOUT / HZ)
+			timeout = MAX_TIMEOUT;
+		else {
+			timeout *= HZ;
+			timeout += USEC_TO_TICKS(get_fs_long((unsigned long *)&tvp->tv_usec));
+		}
+		if (timeout)
+			current->timeout = jiffies + timeout;
+	}
+	i = do_select(in, out, &res_in, &res_out, forever);
+	// 返回剩余的超时时间
+	if (tvp) {
+		timeout = (current->timeout > jiffies) ? current->timeout - jiffies : 0;
+		verify_area(tvp, sizeof(*tvp));
+		put_fs_long(timeout/HZ, (unsigned long *)&tvp->tv_sec);
+		put_fs_long((timeout%HZ)*(1000000/HZ), (unsigned long *)&tvp->tv_usec);
+	}
+	current->timeout = 0;
+	if (i < 0)
+		return i;
+	if (!i && (current->signal & ~current->blocked))
+		return -EINTR;
+	if (inp) {
+		verify_area(inp, sizeof(fd_set));
+		put_fs_long(res_in, inp);
+	}
+	if (outp) {
+		verify_area(outp, sizeof(fd_set));
+		put_fs_long(res_out, outp);
+	}
+	if (exp) {
+		verify_area(exp, sizeof(fd_set));
+		put_fs_long(0, exp);
+	}
+	return i;
+}
+
+/**
+ * @brief  poll 系统调用
+ * 把 pollfd 数组转换成读写位图交给 do_select()，再把结果写回 revents
+ * @param  fds              用户空间 pollfd 数组
+ * @param  nfds             数组项数
+ * @param  msec             超时毫秒数，小于 0 表示无限期等待
+ * @return int              revents 非 0 的项数
+ */
+int sys_poll(struct pollfd * fds, unsigned int nfds, long msec)
+{
+	fd_set in = 0, out = 0, res_in, res_out;
+	struct file * filp;
+	unsigned int i;
+	int fd, count = 0, bad = 0, forever;
+	short events, revents;
+
+	if (nfds > NR_OPEN)
+		return -EINVAL;
+	verify_area(fds, nfds * sizeof(struct pollfd));
+	for (i = 0 ; i < nfds ; i++) {
+		fd = get_fs_long((unsigned long *)&fds[i].fd);
+		events = get_fs_word((unsigned short *)&fds[i].events);
+		if (fd < 0)
+			continue;
+		if (fd >= NR_OPEN || !(filp = current->filp[fd]) || !filp->f_inode) {
+			bad++;
+			continue;
+		}
+		if (events & POLLIN)
+			in |= 1UL << fd;
+		if (events & POLLOUT)
+			out |= 1UL << fd;
+	}
+	// 有无效描述符时立即返回，不再睡眠
+	forever = (msec < 0 && !bad);
+	current->timeout = 0;
+	if (msec > 0 && !bad)
+		current->timeout = jiffies + ((msec / (1000/HZ) >= MAX_TIMEOUT) ?
+			MAX_TIMEOUT : MSEC_TO_TICKS((unsigned long) msec));
+	i = do_select(in, out, &res_in, &res_out, forever);
+	current->timeout = 0;
+	if ((int) i < 0)
+		return i;
+	for (i = 0 ; i < nfds ; i++) {
+		fd = get_fs_long((unsigned long *)&fds[i].fd);
+		revents = 0;
+		if (fd >= 0) {
+			if (fd >= NR_OPEN || !(filp = current->filp[fd]) || !filp->f_inode)
+				revents = POLLNVAL;
+			else {
+				if (res_in & (1UL << fd))
+					revents |= POLLIN;
+				if (res_out & (1UL << fd))
+					revents |= POLLOUT;
+				// 只有管道能判断对端已关闭。终端没有挂断(hangup)状态(串口的
+				// DCD 变化不做处理)，其他字符设备也没有“对端”，都不报告 POLLHUP
+				if (filp->f_inode->i_pipe && filp->f_inode->i_count != 2)
+					revents |= POLLHUP;
+			}
+		}
+		put_fs_word(revents, (short *)&fds[i].revents);
+		if (revents)
+			count++;
+	}
+	if (!count && (current->signal & ~current->blocked))
+		return -EINTR;
+	return count;
+}
@@ -0,0 +1,28 @@
+#ifndef _ASM_DIV64_H
+#define _ASM_DIV64_H
+
+/*
+ * do_div(n, base) divides the unsigned long long n by the unsigned long
+ * base in place and returns the remainder. The kernel isn't linked with
+ * libgcc, so 64-bit divisions have to be done with divl like this.
+ */
+/*
+ * 64 位数 n 除以 32 位数 base：商存回 n，返回余数。内核不连接 libgcc，64 位除法只能这样做。
+ */
+#define do_div(n, base) ({                                           \
+    unsigned long __upper, __low, __high, __mod, __base;            \
+    __base = (base);                                                 \
+    __asm__("" : "=a"(__low), "=d"(__high) : "A"(n));                \
+    __upper = __high;                                                \
+    if (__high) {                                                    \
+        __upper = __high % __base;                                   \
+        __high = __high / __base;                                    \
+    }                                                                \
+    __asm__("divl %2"                                                \
+            : "=a"(__low), "=d"(__mod)                               \
+            : "rm"(__base), "0"(__low), "1"(__upper));               \
+    __asm__("" : "=A"(n) : "a"(__low), "d"(__high));                 \
+    __mod;                                                           \
+})
+
+#endif
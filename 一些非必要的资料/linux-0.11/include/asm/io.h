@@ -30,3 +30,18 @@ __asm__ volatile ("inb %%dx,%%al\n" \
 	"1:":"=a" (_v):"d" (port)); \
 _v; \
 })
+
+/**
+ * @brief  向端口 port 输出 32 位数据(PCI 配置空间、总线主控寄存器使用)
+ */
+#define outl(value,port) \
+__asm__ ("outl %%eax,%%dx"::"a" (value),"d" (port))
+
+/**
+ * @brief  从端口 port 读入 32 位数据
+ */
+#define inl(port) ({ \
+unsigned long _v; \
+__asm__ volatile ("inl %%dx,%%eax":"=a" (_v):"d" (port)); \
+_v; \
+})
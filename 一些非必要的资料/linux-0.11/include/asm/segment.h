@@ -44,6 +44,41 @@ extern inline void put_fs_long(unsigned long val,unsigned long * addr)
 __asm__ ("movl %0,%%fs:%1"::"r" (val),"m" (*addr));
 }
 
+/**
+ * @brief 从用户数据段(fs)批量拷贝n 个字节到内核地址to
+ * movs 的源操作数可以使用段超越前缀，因此一条 rep movsb 即可完成，
+ * 避免逐字节调用get_fs_byte()
+ * @param  to               内核目的地址
+ * @param  from             用户空间源地址
+ * @param  n                字节数
+ */
+extern inline void memcpy_fromfs(void * to, const void * from, unsigned long n)
+{
+__asm__ ("cld\n\t"
+	"fs ; rep ; movsb"
+	::"c" (n),"D" ((long) to),"S" ((long) from)
+	:"cx","di","si");
+}
+
+/**
+ * @brief 从内核地址from 批量拷贝n 个字节到用户数据段(fs)
+ * 目的操作数固定使用es，因此临时将es 切换为fs
+ * @param  to               用户空间目的地址
+ * @param  from             内核源地址
+ * @param  n                字节数
+ */
+extern inline void memcpy_tofs(void * to, const void * from, unsigned long n)
+{
+__asm__ ("cld\n\t"
+	"push %%es\n\t"
+	"push %%fs\n\t"
+	"pop %%es\n\t"
+	"rep ; movsb\n\t"
+	"pop %%es"
+	::"c" (n),"D" ((long) to),"S" ((long) from)
+	:"cx","di","si");
+}
+
 /*
  * Someone who knows GNU asm better than I should double check the followig.
  * It seems to work, but I don't know if I'm doing something subtly wrong.
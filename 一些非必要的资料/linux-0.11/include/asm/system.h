@@ -1,3 +1,6 @@
+#ifndef _ASM_SYSTEM_H
+#define _ASM_SYSTEM_H
+
 
 /**
  * @brief 切换到用户模式
@@ -17,12 +20,83 @@
             "movw %%ax,%%gs" ::        \
                 : "ax")
 
+#include <linux/config.h>
+
+#ifdef LATENCY_TIMING
+/*
+ * Time the sections with interrupts off (kernel/latency.c): a cli() that
+ * turns interrupts off starts one, an sti() or a restore_flags() that
+ * turns them back on ends it.
+ */
+/* 测量关中断的时间：真正关中断的 cli() 开始一段，开中断的 sti()/restore_flags() 结束 */
+extern void irqsoff_start(const char * file, int line);
+extern void irqsoff_end(void);
+
+#define sti() do { irqsoff_end(); __asm__("sti" ::); } while (0)
+#define cli() do {                                                    \
+    unsigned long __f;                                                \
+    __asm__ __volatile__("pushfl ; popl %0 ; cli" : "=r" (__f) : : "memory"); \
+    if (__f & 0x200)                                                  \
+        irqsoff_start(__FILE__, __LINE__);                            \
+} while (0)
+#else
+#define irqsoff_end() do { } while (0)
 #define sti() __asm__("sti" ::)
 #define cli() __asm__("cli" ::)
+#endif
 #define nop() __asm__("nop" ::)
 
+/**
+ * @brief 保存/恢复标志寄存器(含中断允许位 IF)
+ * 用于在可能已关中断的上下文中临时关中断，退出时恢复原来的状态
+ */
+#define save_flags(x) __asm__ __volatile__("pushfl ; popl %0" : "=r" (x) : : "memory")
+#ifdef LATENCY_TIMING
+#define restore_flags(x) do {                                         \
+    unsigned long __f = (x);                                          \
+    if (__f & 0x200)                                                  \
+        irqsoff_end();                                                \
+    __asm__ __volatile__("pushl %0 ; popfl" : : "r" (__f) : "memory"); \
+} while (0)
+#else
+#define restore_flags(x) __asm__ __volatile__("pushl %0 ; popfl" : : "r" (x) : "memory")
+#endif
+
 #define iret() __asm__("iret" ::)
 
+/**
+ * @brief 检查 CPU 是否有 cpuid 指令：EFLAGS 的 ID 位(位 21)可以改变时才有
+ */
+#define has_cpuid() ({                                            \
+    unsigned long __a, __b;                                       \
+    __asm__("pushfl ; popl %0\n\t"                                \
+            "movl %0,%1\n\t"                                      \
+            "xorl %2,%0\n\t"                                      \
+            "pushl %0 ; popfl\n\t"                                \
+            "pushfl ; popl %0\n\t"                                \
+            "pushl %1 ; popfl"                                    \
+            : "=&r"(__a), "=&r"(__b) : "i"(0x00200000));          \
+    (__a ^ __b) & 0x00200000;                                     \
+})
+
+/**
+ * @brief 执行 cpuid 指令(机器码 0f a2)，调用前需确认 CPU 支持(EFLAGS 的 ID 位可以改变)
+ */
+#define cpuid(op, a, b, c, d)                                     \
+    __asm__(".byte 0x0f,0xa2"                                     \
+            : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "0"(op))
+
+/**
+ * @brief 读时间戳计数器(rdtsc，机器码 0f 31)，结果是 64 位的 edx:eax
+ */
+#define rdtsc(val) __asm__ __volatile__(".byte 0x0f,0x31" : "=A"(val))
+
+/**
+ * @brief 写模型专用寄存器 MSR(wrmsr，机器码 0f 30)
+ */
+#define wrmsr(msr, lo, hi) \
+    __asm__ __volatile__(".byte 0x0f,0x30" ::"c"(msr), "a"(lo), "d"(hi))
+
 /**
  * @brief
  * https://blog.csdn.net/Minorant/article/details/123400302?spm=1001.2101.3001.6661.1&utm_medium=distribute.pc_relevant_t0.none-task-blog-2%7Edefault%7EBlogCommendFromBaidu%7Edefault-1-123400302-blog-79459006.pc_relevant_sortByStrongTime&depth_1-utm_source=distribute.pc_relevant_t0.none-task-blog-2%7Edefault%7EBlogCommendFromBaidu%7Edefault-1-123400302-blog-79459006.pc_relevant_sortByStrongTime&utm_relevant_index=1
@@ -75,3 +149,5 @@
 
 #define set_tss_desc(n, addr) _set_tssldt_desc(((char *)(n)), addr, "0x89")
 #define set_ldt_desc(n, addr) _set_tssldt_desc(((char *)(n)), addr, "0x82")
+
+#endif
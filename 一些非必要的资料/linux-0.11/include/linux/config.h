@@ -45,4 +45,12 @@
  leave HD_TYPE undefined. This is the normal thing to do.
 */
 
+/*
+ * Define LATENCY_TIMING to time every cli()/sti() section in C code and
+ * the delay from waking a task to running it (kernel/latency.c). The
+ * worst cases are shown with the task list on a function key. It needs
+ * a CPU with a TSC and costs a call on every cli().
+ */
+/* #define LATENCY_TIMING */
+
 #endif
@@ -6,7 +6,7 @@
 #ifndef _FDREG_H
 #define _FDREG_H
 
-extern int ticks_to_floppy_on(unsigned int nr);
+extern unsigned long long floppy_on_time(unsigned int nr);
 extern void floppy_on(unsigned int nr);
 extern void floppy_off(unsigned int nr);
 extern void floppy_select(unsigned int nr);
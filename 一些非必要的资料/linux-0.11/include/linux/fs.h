@@ -7,6 +7,7 @@
 #define _FS_H
 
 #include <sys/types.h>
+#include <linux/wait.h>
 
 /* devices are as follows: (same as minix, so we can use the minix
  * file system. These are major numbers.)
@@ -76,7 +77,7 @@ struct buffer_head
     unsigned char b_dirt; /* 0-clean,1-dirty */            //< 是否为脏数据--正在读写
     unsigned char b_count; /* users using this block */    //< 文件引用计数
     unsigned char b_lock; /* 0 - ok, 1 -locked */          //< 是否已经被锁住
-    struct task_struct *b_wait;                            //< 等待中断的节点
+    struct wait_queue *b_wait;                             //< 等待中断的节点
     struct buffer_head *b_prev;                            //< 链表指针前一个
     struct buffer_head *b_next;                            //< 链表指针后一个
     struct buffer_head *b_prev_free;                       //< 空闲链表指针，前一个
@@ -106,7 +107,7 @@ struct m_inode
     unsigned char i_nlinks;     //< 文件目录项目链接数
     unsigned short i_zone[9];   //< 数据占用的block 号，最多为9个块=7个直接块 + 1 * 一次间接块 + 1 * 二次间接块
                                 /* these are in memory also */
-    struct task_struct *i_wait; //< 正在等待的i节点进程
+    struct wait_queue *i_wait;  //< 正在等待的i节点进程
     unsigned long i_atime;      //< 最后访问时间
     unsigned long i_ctime;      //< 节点自身修改时间
     unsigned short i_dev;       //< inode节点对应设备号
@@ -151,7 +152,7 @@ struct super_block
     struct m_inode *s_isup;         //< 被安装文件系统根目录i节点
     struct m_inode *s_imount;       //< 该文件系统被安装到的i节点
     unsigned long s_time;           //< 修改时间
-    struct task_struct *s_wait;     //< 等待本超级块的进程指针
+    struct wait_queue *s_wait;      //< 等待本超级块的进程指针
     unsigned char s_lock;           //< 锁定标志
     unsigned char s_rd_only;        //< 只读标志
     unsigned char s_dirt;           //< 已经被修改(脏)标志
@@ -186,7 +187,7 @@ extern int nr_buffers;
 
 extern void check_disk_change(int dev);
 extern int floppy_change(unsigned int nr);
-extern int ticks_to_floppy_on(unsigned int dev);
+extern unsigned long long floppy_on_time(unsigned int dev);
 extern void floppy_on(unsigned int dev);
 extern void floppy_off(unsigned int dev);
 extern void truncate(struct m_inode *inode);
@@ -202,6 +203,8 @@ extern struct m_inode *iget(int dev, int nr);
 extern struct m_inode *get_empty_inode(void);
 extern struct m_inode *get_pipe_inode(void);
 extern struct buffer_head *get_hash_table(int dev, int block);
+extern struct buffer_head *rd_getblk(int dev, int block);
+extern int rd_mapped(struct buffer_head * bh);
 extern struct buffer_head *getblk(int dev, int block);
 extern void ll_rw_block(int rw, struct buffer_head *bh);
 extern void brelse(struct buffer_head *buf);
@@ -45,6 +45,37 @@
 #define WIN_SEEK 		0x70
 #define WIN_DIAGNOSE		0x90
 #define WIN_SPECIFY		0x91
+#define WIN_READDMA		0xC8
+#define WIN_WRITEDMA		0xCA
+#define WIN_MULTREAD		0xC4	/* read sectors using multiple mode */
+#define WIN_MULTWRITE		0xC5	/* write sectors using multiple mode */
+#define WIN_SETMULT		0xC6	/* enable/disable multiple mode */
+#define WIN_IDENTIFY		0xEC
+
+/* 48-bit LBA versions of the read/write commands */
+#define WIN_READ_EXT		0x24
+#define WIN_READDMA_EXT		0x25
+#define WIN_WRITE_EXT		0x34
+#define WIN_WRITEDMA_EXT	0x35
+#define WIN_MULTREAD_EXT	0x29
+#define WIN_MULTWRITE_EXT	0x39
+
+/* Largest sector number + 1 reachable with 28-bit LBA */
+#define LBA28_LIMIT	0x10000000
+
+/* PCI bus-master IDE registers, offsets from BAR4 (primary channel) */
+#define BM_COMMAND	0x00	/* start/stop and direction */
+#define BM_STATUS	0x02	/* active, error, interrupt */
+#define BM_PRD		0x04	/* physical address of the PRD table */
+
+/* Bits of BM_COMMAND */
+#define BM_CMD_START	0x01
+#define BM_CMD_READ	0x08	/* device -> memory */
+
+/* Bits of BM_STATUS */
+#define BM_STAT_ACTIVE	0x01
+#define BM_STAT_ERR	0x02
+#define BM_STAT_INTR	0x04
 
 /* Bits for HD_ERROR */
 #define MARK_ERR	0x01	/* Bad address mark ? */
@@ -0,0 +1,49 @@
+/*
+ * High-resolution timers (kernel/hrtimer.c). They work like the timers
+ * in <linux/timer.h>, but expire at a time in nanoseconds since boot
+ * (hr_now()) instead of at a jiffy. Timers due before the next clock
+ * tick are run from the RTC periodic interrupt, which is only enabled
+ * then, so they fire within about 122us of their time.
+ */
+
+/*
+ * 高精度定时器。用法与 <linux/timer.h> 中的定时器相同，只是到期时间是开机以来的
+ * 纳秒数(hr_now())。在下一个时钟滴答之前到期的定时器由 RTC 的周期中断(8192Hz，
+ * 只在这时打开)执行，误差约 122 微秒。处理函数在中断中关中断执行。
+ */
+
+#ifndef _HRTIMER_H
+#define _HRTIMER_H
+
+#define NSEC_PER_SEC	1000000000L
+#define NSEC_PER_MSEC	1000000L
+#define NSEC_PER_JIFFY	(NSEC_PER_SEC / HZ)	/* 需要 <linux/sched.h> 中的 HZ */
+
+#define SEC_NS(s)	((unsigned long long) (s) * NSEC_PER_SEC)
+#define MSEC_NS(ms)	((unsigned long long) (ms) * NSEC_PER_MSEC)
+
+struct hrtimer {
+	struct hrtimer * next;
+	struct hrtimer ** pprev;	/* NULL when not pending */
+	unsigned long long expires;	/* ns since boot */
+	void (*function)(unsigned long);
+	unsigned long data;
+};
+
+#define hrtimer_pending(t) ((t)->pprev != NULL)
+
+extern unsigned long long hr_now(void);
+extern void hrtimer_init(struct hrtimer * timer,
+	void (*function)(unsigned long), unsigned long data);
+extern void hrtimer_start(struct hrtimer * timer, unsigned long long expires);
+extern int hrtimer_cancel(struct hrtimer * timer);
+extern void run_hrtimers(void);
+extern unsigned long next_hrtimer_jiffies(unsigned long limit);
+extern void hrtimer_init_rtc(void);
+
+/* TSC clock source (kernel/tsc.c); tsc_khz is 0 when there is no TSC */
+extern unsigned long tsc_khz;
+extern void tsc_init(void);
+extern unsigned long cycles_to_ns(unsigned long long cycles);
+
+#endif
@@ -0,0 +1,36 @@
+/*
+ * Bottom halves (kernel/softirq.c). A hardware interrupt handler runs
+ * with interrupts off, so it only does what cannot wait: acknowledge
+ * the device and take its data. The rest is marked with mark_bh() and
+ * run by do_bottom_half() with interrupts on, just before the interrupt
+ * (or system call) returns. Bottom halves never nest: one marked while
+ * another is running is picked up by the running do_bottom_half().
+ */
+
+/*
+ * 中断的下半部。硬件中断处理程序只应答设备、取走数据，其余工作用 mark_bh() 登记，
+ * 在中断返回前由 do_bottom_half() 开着中断执行，这样慢的工作(如硬盘的数据传输)
+ * 不会挡住其他中断。下半部之间不会嵌套。
+ */
+
+#ifndef _INTERRUPT_H
+#define _INTERRUPT_H
+
+#define HD_BH		0	/* 硬盘中断的处理(kernel/blk_drv/hd.c) */
+#define TTY_BH		1	/* 键盘和串口的输入处理 copy_to_cooked()(tty_io.c) */
+
+extern unsigned long bh_active;
+
+/**
+ * @brief  登记下半部，在中断返回前执行。可以在关中断时调用
+ * @param  nr               下半部编号
+ */
+extern inline void mark_bh(int nr)
+{
+	__asm__ __volatile__("btsl %1,%0":"=m" (bh_active):"ir" (nr));
+}
+
+extern void init_bh(int nr, void (*routine)(void));
+extern void do_bottom_half(void);
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * Compressed images (ram disk, kernel) use a plain LZSS stream: a flag
+ * byte announces the next 8 items, LSB first. A set bit is a literal
+ * byte, a clear bit a 2-byte match: the low 12 bits are the distance-1
+ * back into the output, the high 4 bits the length-LZSS_MIN_MATCH.
+ *
+ * It is much simpler than deflate, and the decoder needs no tables and
+ * no memory besides the output itself.
+ */
+
+#ifndef _LZSS_H
+#define _LZSS_H
+
+#define LZSS_WINDOW	4096	/* largest match distance */
+#define LZSS_MIN_MATCH	3	/* shorter matches are sent as literals */
+#define LZSS_MAX_MATCH	18
+
+/*
+ * Header in front of a compressed ram disk image (block 256 of the
+ * boot floppy) or of the system in a zImage, followed directly by the
+ * LZSS stream.
+ */
+#define RDZ_MAGIC	0x5a445200	/* "\0RDZ" */
+
+struct rdz_header {
+	unsigned long magic;
+	unsigned long size;	/* uncompressed bytes */
+	unsigned long zsize;	/* compressed bytes after the header */
+};
+
+/*
+ * Decompress into out (at most size bytes), reading input through
+ * getb(), which returns the next byte or -1 at the end. Returns the
+ * number of bytes produced, or -1 for a corrupt stream.
+ */
+extern long lzss_decode(char * out, long size, int (*getb)(void));
+
+#endif
@@ -10,6 +10,7 @@
 #include <linux/head.h>
 #include <linux/fs.h>
 #include <linux/mm.h>
+#include <linux/timer.h>
 #include <signal.h>
 
 #if (NR_OPEN > 32)
@@ -115,7 +116,8 @@ struct task_struct
     long pid, father, pgrp, session, leader;                        //< 进程相关session
     unsigned short uid, euid, suid;                                 //< 进程所属用户ID
     unsigned short gid, egid, sgid; //< 对应用户组ID
-    long alarm;
+    long alarm;                                                     //< ITIMER_REAL 下一次到期的滴答数，0 表示没有启动
+    long timeout;                                                   //< 睡眠超时的滴答数(select/poll 使用)，到期时唤醒可中断睡眠的任务
     long utime, stime, cutime, cstime, start_time; // 用户态时间、核心态时间、子进程用户态和核心态时间。
     unsigned short used_math;
     /* file system info */
@@ -129,7 +131,21 @@ struct task_struct
                                 /* ldt for this task 0 - zero 1 - cs 2 - ds&ss */
     struct desc_struct ldt[3];  //< 描述结构体--描述符基础地址
     /* tss for this task */
-    struct tss_struct tss;  //< 任务TSS寄存器
+    struct tss_struct tss;  //< 任务TSS，现在只用其中的 i387(协处理器状态)；任务 0 的是唯一装入 TR 的 TSS
+    /* interval timers, see kernel/itimer.c */
+    struct timer_list real_timer;   //< ITIMER_REAL 的定时器，到期时调用 it_real_fn()
+    unsigned long it_real_incr;     //< ITIMER_REAL 的间隔(滴答)
+    unsigned long it_virt_value, it_virt_incr;  //< ITIMER_VIRTUAL 剩余值和间隔(用户态滴答)
+    unsigned long it_prof_value, it_prof_incr;  //< ITIMER_PROF 剩余值和间隔(运行滴答)
+    long ksp;   //< 切换出去时的内核栈指针，见 switch_to()
+    unsigned long long utime_ns, stime_ns;  //< 有 TSC 时统计的用户态、内核态时间(纳秒)，utime/stime 由它们换算
+    /* profiling, see kernel/prof.c */
+    unsigned long prof_base, prof_size;     //< 用户态计数缓冲区的地址和字节数
+    unsigned long prof_off, prof_scale;     //< 地址起点和比例，prof_scale 为 0 表示不剖析
+    long sys_nr;                            //< 正在统计的系统调用号，-1 表示没有统计(kernel/sysstat.c)
+    unsigned long long sys_start;           //< 这次系统调用开始的时间(TSC 值，没有 TSC 时为纳秒数)
+    unsigned long long wake_tsc;            //< 被唤醒时的 TSC 值，0 表示没有(LATENCY_TIMING，kernel/latency.c)
+    unsigned long prof_ticks, prof_pc;      //< 还没写入用户计数缓冲区的采样，返回用户态时写入(kernel/system_call.s 用到偏移)
 };
 
 /*
@@ -142,7 +158,7 @@ struct task_struct
 /* ec,brk... */	0,0,0,0,0,0, \
 /* pid etc.. */	0,-1,0,0,0, \
 /* uid etc */	0,0,0,0,0,0, \
-/* alarm */	0,0,0,0,0,0, \
+/* alarm */	0,0,0,0,0,0,0, \
 /* math */	0, \
 /* fs info */	-1,0022,NULL,NULL,NULL,0, \
 /* filp */	{NULL,}, \
@@ -167,10 +183,16 @@ extern long startup_time;
 
 #define CURRENT_TIME (startup_time + jiffies / HZ)
 
-extern void add_timer(long jiffies, void (*fn)(void));
-extern void sleep_on(struct task_struct **p);
-extern void interruptible_sleep_on(struct task_struct **p);
-extern void wake_up(struct task_struct **p);
+extern void it_real_fn(unsigned long data);
+extern void set_alarm(long expires);
+extern void add_wait_queue(struct wait_queue **p, struct wait_queue *wait);
+extern void remove_wait_queue(struct wait_queue **p, struct wait_queue *wait);
+extern void sleep_on(struct wait_queue **p);
+extern void sleep_on_exclusive(struct wait_queue **p);
+extern void interruptible_sleep_on(struct wait_queue **p);
+extern void wake_up(struct wait_queue **p);
+extern void wake_up_all(struct wait_queue **p);
+extern void wake_up_process(struct task_struct *p);
 
 /*
  * Entry into gdt where to find first TSS. 0-nul, 1-cs, 2-ds, 3-syscall
@@ -182,36 +204,17 @@ extern void wake_up(struct task_struct **p);
 #define _LDT(n) ((((unsigned long)n) << 4) + (FIRST_LDT_ENTRY << 3))
 #define ltr(n) __asm__("ltr %%ax" ::"a"(_TSS(n)))
 #define lldt(n) __asm__("lldt %%ax" ::"a"(_LDT(n)))
-#define str(n)                  \
-    __asm__("str %%ax\n\t"      \
-            "subl %2,%%eax\n\t" \
-            "shrl $4,%%eax"     \
-            : "=a"(n)           \
-            : "a"(0), "i"(FIRST_TSS_ENTRY << 3))
 /*
  *	switch_to(n) should switch tasks to task nr n, first
  * checking that n isn't the current task, in which case it does nothing.
  * This also clears the TS-flag if the task we switched to has used
  * tha math co-processor latest.
+ *
+ * The switch is done in software (kernel/sched.c): there is only one
+ * TSS, task 0's, and only its esp0 is changed. The kernel stacks are
+ * swapped by switch_stacks() in system_call.s.
  */
-#define switch_to(n)                                  \
-    {                                                 \
-        struct                                        \
-        {                                             \
-            long a, b;                                \
-        } __tmp;                                      \
-        __asm__("cmpl %%ecx,_current\n\t"             \
-                "je 1f\n\t"                           \
-                "movw %%dx,%1\n\t"                    \
-                "xchgl %%ecx,_current\n\t"            \
-                "ljmp %0\n\t"                         \
-                "cmpl %%ecx,_last_task_used_math\n\t" \
-                "jne 1f\n\t"                          \
-                "clts\n"                              \
-                "1:" ::"m"(*&__tmp.a),                \
-                "m"(*&__tmp.b),                       \
-                "d"(_TSS(n)), "c"((long)task[n]));    \
-    }
+extern void switch_to(int n);
 
 #define PAGE_ALIGN(n) (((n) + 0xfff) & 0xfffff000)
 
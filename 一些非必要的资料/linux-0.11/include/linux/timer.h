@@ -0,0 +1,44 @@
+/*
+ * Kernel timers are kept in a timer wheel (kernel/timer.c): five levels
+ * of buckets indexed by bits of the expiry time, so adding and deleting
+ * a timer is O(1) however many are pending. Timers that are far away
+ * are moved down a level (cascaded) only when their turn comes.
+ *
+ * A timer is owned by its user, usually embedded in a bigger structure:
+ * set function and data with init_timer(), start it with mod_timer() and
+ * stop it with del_timer(). The function runs from do_timer() with
+ * interrupts disabled, once, at the first tick with jiffies >= expires.
+ */
+
+/*
+ * 内核定时器。由使用者自己提供(通常嵌在其它结构中)，init_timer() 设置处理函数和参数，
+ * mod_timer() 启动，del_timer() 取消。到期时处理函数在 do_timer() 中关中断执行一次。
+ */
+
+#ifndef _TIMER_H
+#define _TIMER_H
+
+struct timer_list {
+	struct timer_list * next;
+	struct timer_list ** pprev;	/* NULL when not pending */
+	unsigned long expires;		/* jiffies at which it fires */
+	void (*function)(unsigned long);
+	unsigned long data;
+};
+
+#define timer_pending(t) ((t)->pprev != NULL)
+
+extern void init_timer(struct timer_list * timer,
+	void (*function)(unsigned long), unsigned long data);
+extern void mod_timer(struct timer_list * timer, unsigned long expires);
+extern int del_timer(struct timer_list * timer);
+extern void run_timers(void);
+extern unsigned long next_timer_jiffies(unsigned long max);
+
+/*
+ * The old interface: call fn after the given number of ticks. The entry
+ * is allocated by the kernel and can't be cancelled.
+ */
+extern void add_timer(long jiffies, void (*fn)(void));
+
+#endif
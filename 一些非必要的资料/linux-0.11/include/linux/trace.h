@@ -0,0 +1,55 @@
+/*
+ * Static tracepoints (kernel/trace.c). trace(event, a, b) puts a fixed
+ * size record with a timestamp and the current pid into a ring buffer.
+ * An event that is not enabled in trace_mask costs one test and jump.
+ * When the buffer is full the oldest records are overwritten, and the
+ * reader sees a TRACE_LOST record with the number lost.
+ *
+ * The records are read (and consumed) from /dev/trace, minor 5 of the
+ * memory device (mknod /dev/trace c 1 5). Writing a 4-byte mask there
+ * selects the events. A function key also dumps them in hex to the
+ * first serial port. tools/tracedump decodes either form on the host.
+ */
+
+/*
+ * 静态跟踪点。记录(时间、进程号、事件、两个参数)写入环形缓冲区，事件没有在
+ * trace_mask 中打开时只多一次判断。从 /dev/trace 读出，或者按功能键从串口 1 输出，
+ * 在主机上用 tools/tracedump 解码。
+ */
+
+#ifndef _TRACE_H
+#define _TRACE_H
+
+struct trace_rec {
+	unsigned long time;		/* us since boot, wraps after ~71 min */
+	unsigned short event;
+	unsigned short pid;
+	unsigned long a, b;
+};
+
+#define TRACE_LOST	0	/* a = records overwritten */
+#define TRACE_SWITCH	1	/* a = pid switched out, b = pid switched in */
+#define TRACE_WAKEUP	2	/* a = pid woken */
+#define TRACE_BLK_QUEUE	3	/* a = dev, b = sector; request queued */
+#define TRACE_BLK_START	4	/* a = dev, b = sector; driver starts (or retries) it */
+#define TRACE_BLK_DONE	5	/* a = dev | uptodate << 16, b = sector */
+#define TRACE_PAGE_FAULT 6	/* a = linear address, b = error code */
+#define TRACE_SYS_ENTER	7	/* a = syscall nr, b = first argument */
+#define TRACE_SYS_EXIT	8	/* a = return value */
+#define TRACE_BUF_HIT	9	/* a = dev, b = block; bread() found it uptodate */
+#define TRACE_BUF_MISS	10	/* a = dev, b = block; bread() had to read it */
+
+#define TRACE_NR_EVENTS	11
+
+extern unsigned long trace_mask;
+extern void __trace(int event, unsigned long a, unsigned long b);
+
+#define trace(event, a, b) do { \
+	if (trace_mask & (1 << (event))) \
+		__trace((event), (unsigned long) (a), (unsigned long) (b)); \
+} while (0)
+
+extern int rw_trace(int rw, char * buf, int count);
+extern void trace_dump(void);
+
+#endif
@@ -10,6 +10,7 @@
 #define _TTY_H
 
 #include <termios.h>
+#include <linux/wait.h>
 
 #define TTY_BUF_SIZE 1024
 
@@ -23,7 +24,7 @@ struct tty_queue
 	unsigned long data;			   //< 等待队列缓冲区中当前数据统计值，对于串口终端，存放串口端口地址。
 	unsigned long head;			   //< 缓冲区中数据头指针
 	unsigned long tail;			   //< 缓冲区中数据尾部指针
-	struct task_struct *proc_list; //< 等待本缓冲队列的进程列表
+	struct wait_queue *proc_list;  //< 等待本缓冲队列的进程队列
 	char buf[TTY_BUF_SIZE];		   //< 队列缓冲区，长度为1页
 };
 
@@ -81,6 +82,7 @@ void tty_init(void);
 
 int tty_read(unsigned c, char * buf, int n);
 int tty_write(unsigned c, char * buf, int n);
+int tty_ready(unsigned c, int rw);
 
 void rs_write(struct tty_struct * tty);
 void con_write(struct tty_struct * tty);
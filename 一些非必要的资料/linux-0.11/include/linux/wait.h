@@ -0,0 +1,28 @@
+#ifndef _LINUX_WAIT_H
+#define _LINUX_WAIT_H
+
+/*
+ * Wait queues. The object being waited for keeps a pointer to the first
+ * entry; each sleeper links an entry from its own kernel stack into the
+ * list for as long as it sleeps, so any number of tasks can wait at once
+ * and a wakeup reaches all of them without them waking each other.
+ */
+
+/**
+ * @brief 独占等待标志
+ * wake_up() 唤醒所有非独占的等待者，但只唤醒一个独占的等待者，
+ * 用于"释放一个资源只够一个进程使用"的场合(空闲请求项、空闲缓冲块)
+ */
+#define WQ_FLAG_EXCLUSIVE	0x01
+
+/**
+ * @brief 等待队列项
+ * 由睡眠进程放在自己的内核栈上，链入被等待对象的队列，醒来后再摘除
+ */
+struct wait_queue {
+	struct task_struct * task;	//< 等待的进程
+	struct wait_queue * next;	//< 队列中的下一项
+	int flags;			//< WQ_FLAG_EXCLUSIVE 等
+};
+
+#endif
@@ -32,6 +32,8 @@ typedef unsigned int sigset_t; /* 32 bits */
 #define SIGTSTP 20
 #define SIGTTIN 21
 #define SIGTTOU 22
+#define SIGVTALRM 26
+#define SIGPROF 27
 
 /* Ok, I haven't implemented sigactions, but trying to keep headers POSIX */
 #define SA_NOCLDSTOP 1
@@ -0,0 +1,39 @@
+#ifndef _SYS_PROF_H
+#define _SYS_PROF_H
+
+/*
+ * Execution profiling, see kernel/prof.c. On every clock tick the pc of
+ * the interrupted code selects a counter:
+ *
+ *	index = ((pc - pr_off) * pr_scale) >> 17
+ *
+ * so a pr_scale of 0x10000 gives one counter for every 2 bytes of code,
+ * 0x8000 one for every 4 bytes and so on. Samples outside the buffer
+ * are dropped.
+ */
+
+struct prof {
+	unsigned short * pr_base;	/* buffer (PROF_USER, PROF_KREAD) */
+	unsigned long pr_size;		/* buffer size in bytes */
+	unsigned long pr_off;		/* lowest pc profiled */
+	unsigned long pr_scale;		/* pc scale, 0 turns profiling off */
+};
+
+/*
+ * PROF_USER	user mode pc of this process into its own 16-bit
+ *		counters; inherited by fork(), turned off by exec().
+ * PROF_KERNEL	kernel pc, whatever process is running, into the kernel's
+ *		own 32-bit counters (PROF_KSLOTS of them). Superuser only,
+ *		clears the counters. pr_base and pr_size are not used.
+ * PROF_KREAD	copy the kernel counters to pr_base; pr_off and pr_scale
+ *		are set to the values in use. Returns the bytes copied.
+ */
+#define PROF_USER	0
+#define PROF_KERNEL	1
+#define PROF_KREAD	2
+
+#define PROF_KSLOTS	4096
+
+int prof(int which, struct prof * pr);
+
+#endif
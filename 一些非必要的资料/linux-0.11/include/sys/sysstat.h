@@ -0,0 +1,26 @@
+#ifndef _SYS_SYSSTAT_H
+#define _SYS_SYSSTAT_H
+
+/*
+ * Per system call statistics, see kernel/sysstat.c. Times are in
+ * nanoseconds from entering system_call to leaving it, so they include
+ * any sleep in the call; calls longer than about 4 seconds count as that.
+ */
+
+struct sysstat {
+	unsigned long count;		/* calls */
+	unsigned long max;		/* longest call */
+	unsigned long long total;	/* sum of all calls */
+	unsigned long hist[32];		/* hist[i]: calls taking 2^i to 2^(i+1)-1 ns */
+};
+
+#define SYSSTAT_OFF	0	/* stop collecting */
+#define SYSSTAT_ON	1	/* start collecting */
+#define SYSSTAT_RESET	2	/* clear all counters */
+#define SYSSTAT_READ	3	/* copy the first n entries, indexed by call nr */
+
+#define SYSSTAT_NR	96	/* entries kept, at least nr_system_calls */
+
+int sysstat(int cmd, struct sysstat * buf, int n);
+
+#endif
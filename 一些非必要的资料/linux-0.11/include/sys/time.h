@@ -0,0 +1,31 @@
+#ifndef _SYS_TIME_H
+#define _SYS_TIME_H
+
+#include <sys/types.h>
+
+struct timeval {
+	long	tv_sec;		/* seconds */
+	long	tv_usec;	/* microseconds */
+};
+
+struct timezone {
+	int	tz_minuteswest;	/* minutes west of Greenwich */
+	int	tz_dsttime;	/* type of dst correction */
+};
+
+#define	ITIMER_REAL	0	/* real time, SIGALRM */
+#define	ITIMER_VIRTUAL	1	/* user mode time, SIGVTALRM */
+#define	ITIMER_PROF	2	/* user and kernel time, SIGPROF */
+
+struct itimerval {
+	struct	timeval it_interval;	/* timer interval */
+	struct	timeval it_value;	/* current value */
+};
+
+int select(int width, fd_set * readfds, fd_set * writefds,
+	fd_set * exceptfds, struct timeval * timeout);
+int getitimer(int which, struct itimerval * value);
+int setitimer(int which, struct itimerval * value, struct itimerval * ovalue);
+int gettimeofday(struct timeval * tv, struct timezone * tz);
+
+#endif
@@ -33,6 +33,14 @@ typedef long off_t;
 typedef unsigned char u_char;
 typedef unsigned short ushort;
 
+typedef unsigned long fd_set;
+
+#define FD_SETSIZE		(8*sizeof(fd_set))
+#define FD_SET(fd,fdsetp)	(*(fdsetp) |= (1 << (fd)))
+#define FD_CLR(fd,fdsetp)	(*(fdsetp) &= ~(1 << (fd)))
+#define FD_ISSET(fd,fdsetp)	((*(fdsetp) >> fd) & 1)
+#define FD_ZERO(fdsetp)		(*(fdsetp) = 0)
+
 typedef struct { int quot,rem; } div_t;
 typedef struct { long quot,rem; } ldiv_t;
 
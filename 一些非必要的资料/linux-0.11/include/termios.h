@@ -133,7 +133,7 @@ struct termios
 #define   FF1	0040000
 
 /* c_cflag bit meaning */
-#define CBAUD	0000017
+#define CBAUD	0010017
 #define  B0	0000000		/* hang up */
 #define  B50	0000001
 #define  B75	0000002
@@ -152,6 +152,9 @@ struct termios
 #define  B38400	0000017
 #define EXTA B19200
 #define EXTB B38400
+#define CBAUDEX 0010000
+#define  B57600 0010001
+#define  B115200 0010002
 #define CSIZE	0000060
 #define   CS5	0000000
 #define   CS6	0000020
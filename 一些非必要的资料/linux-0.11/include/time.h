@@ -14,6 +14,10 @@ typedef unsigned int size_t;
 #define CLOCKS_PER_SEC 100
 
 typedef long clock_t;
+typedef int clockid_t;
+
+#define CLOCK_REALTIME	0	/* 1970 年以来的时间 */
+#define CLOCK_MONOTONIC	1	/* 开机以来的时间，不受 stime() 影响 */
 // 时间结构体
 struct tm {
 	int tm_sec; 
@@ -27,6 +31,11 @@ struct tm {
 	int tm_isdst;
 };
 
+struct timespec {
+	time_t	tv_sec;		/* seconds */
+	long	tv_nsec;	/* nanoseconds */
+};
+
 clock_t clock(void);
 time_t time(time_t * tp);
 double difftime(time_t time2, time_t time1);
@@ -38,5 +47,7 @@ struct tm * gmtime(const time_t *tp);
 struct tm *localtime(const time_t * tp);
 size_t strftime(char * s, size_t smax, const char * fmt, const struct tm * tp);
 void tzset(void);
+int nanosleep(const struct timespec * req, struct timespec * rem);
+int clock_gettime(clockid_t clk, struct timespec * tp);
 
 #endif
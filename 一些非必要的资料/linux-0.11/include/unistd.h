@@ -130,14 +130,66 @@
 #define __NR_ssetmask	69
 #define __NR_setreuid	70
 #define __NR_setregid	71
+#define __NR_select	72
+#define __NR_poll	73
+#define __NR_setitimer	74
+#define __NR_getitimer	75
+#define __NR_nanosleep	76
+#define __NR_gettimeofday	77
+#define __NR_clock_gettime	78
+#define __NR_sysstat	79
+
+/*
+ * System calls are made with sysenter when the CPU has it (see
+ * lib/sysenter.c), else with int 0x80. sysenter doesn't save the
+ * user eip and esp, so they are handed to the kernel in esi and ebp;
+ * the kernel returns with iret just as for int 0x80, so ebx, ecx and
+ * edx are preserved in both cases.
+ *
+ * Define __NO_SYSENTER to always use int 0x80 (init/main.c has to: task
+ * 0 must not use its stack after fork()).
+ */
+/*
+ * CPU 支持时用 sysenter 进入系统调用(见 lib/sysenter.c)，否则用 int 0x80。
+ * sysenter 不保存用户态的 eip 和 esp，这里用 esi 和 ebp 把它们交给内核。
+ */
+extern int __sysenter_ok;
+extern int __sysenter_probe(void);
+
+#ifdef __NO_SYSENTER
+#define __use_sysenter() 0
+#else
+#define __use_sysenter() \
+	(__sysenter_ok > 0 || (__sysenter_ok < 0 && __sysenter_probe()))
+#endif
+
+/* sysenter 的机器码是 0f 34 */
+#define __SYSENTER \
+	"pushl %%ebp\n\t" \
+	"movl %%esp,%%ebp\n\t" \
+	"movl $1f,%%esi\n\t" \
+	".byte 0x0f,0x34\n" \
+	"1:\tpopl %%ebp"
+
+/**
+ * @brief 发出系统调用 nr，参数放在 ebx、ecx、edx 中，返回值放在 res 中
+ */
+#define __syscall(res,nr,a,b,c) \
+if (__use_sysenter()) \
+	__asm__ volatile (__SYSENTER \
+		: "=a" (res) \
+		: "0" (nr),"b" ((long)(a)),"c" ((long)(b)),"d" ((long)(c)) \
+		: "si"); \
+else \
+	__asm__ volatile ("int $0x80" \
+		: "=a" (res) \
+		: "0" (nr),"b" ((long)(a)),"c" ((long)(b)),"d" ((long)(c)))
 
 #define _syscall0(type,name) \
 type name(void) \
 { \
 long __res; \
-__asm__ volatile ("int $0x80" \
-	: "=a" (__res) \
-	: "0" (__NR_##name)); \
+__syscall(__res,__NR_##name,0,0,0); \
 if (__res >= 0) \
 	return (type) __res; \
 errno = -__res; \
@@ -148,9 +200,7 @@ return -1; \
 type name(atype a) \
 { \
 long __res; \
-__asm__ volatile ("int $0x80" \
-	: "=a" (__res) \
-	: "0" (__NR_##name),"b" ((long)(a))); \
+__syscall(__res,__NR_##name,a,0,0); \
 if (__res >= 0) \
 	return (type) __res; \
 errno = -__res; \
@@ -161,9 +211,7 @@ return -1; \
 type name(atype a,btype b) \
 { \
 long __res; \
-__asm__ volatile ("int $0x80" \
-	: "=a" (__res) \
-	: "0" (__NR_##name),"b" ((long)(a)),"c" ((long)(b))); \
+__syscall(__res,__NR_##name,a,b,0); \
 if (__res >= 0) \
 	return (type) __res; \
 errno = -__res; \
@@ -174,9 +222,7 @@ return -1; \
 type name(atype a,btype b,ctype c) \
 { \
 long __res; \
-__asm__ volatile ("int $0x80" \
-	: "=a" (__res) \
-	: "0" (__NR_##name),"b" ((long)(a)),"c" ((long)(b)),"d" ((long)(c))); \
+__syscall(__res,__NR_##name,a,b,c); \
 if (__res>=0) \
 	return (type) __res; \
 errno=-__res; \
@@ -10,6 +10,7 @@
  * */
 
 #define __LIBRARY__
+#define __NO_SYSENTER	// 任务 0 在 fork() 之后不能使用堆栈，sysenter 的调用方式要用到
 #include <unistd.h>
 #include <time.h>
 
@@ -79,6 +80,11 @@ extern long startup_time;						 // 内核启动时间（开机时间）（秒）
 #define EXT_MEM_K (*(unsigned short *)0x90002)	   // 1M后扩展内存大小
 #define DRIVE_INFO (*(struct drive_info *)0x90080) // 硬盘参数表，可以见 setup.s
 #define ORIG_ROOT_DEV (*(unsigned short *)0x901FC) // 根文件系统所在设备号。
+#define BOOT_TICKS (*(unsigned long *)0x901F8)	   // bootsect 开始执行时的 BIOS 时钟滴答数
+#define LOAD_TICKS (*(unsigned long *)0x901F0)	   // setup 进入保护模式前的 BIOS 时钟滴答数
+#define TICKS_PER_DAY 0x1800B0					   // BIOS 时钟每天的滴答数(18.2Hz)，午夜回零
+
+static long loader_ms = 0; // 从 bootsect 开始到进入保护模式所用的毫秒数
 
 /*
  * Yeah, yeah, it's ugly, but I cannot find how to do this correctly
@@ -150,6 +156,11 @@ void main(void) /* This really IS void, no error here. */
 	/** 此时中断仍被禁止着，做完必要的设置后就将其开启。      */
 	// 保存根设备号，在setup.s 中被设置
 	ROOT_DEV = ORIG_ROOT_DEV;					// ROOT_DEV 定义在 fs/super.c,29 行。
+	// 引导加载耗时，之后由 jiffies 计算内核部分，在 init() 中一并报告
+	loader_ms = LOAD_TICKS - BOOT_TICKS;
+	if (loader_ms < 0)
+		loader_ms += TICKS_PER_DAY;
+	loader_ms = loader_ms * 10000 / 182;		// 每个 BIOS 滴答约 54.9 毫秒
 	drive_info = DRIVE_INFO;					// 复制硬盘参数表
 	memory_end = (1 << 20) + (EXT_MEM_K << 10); // 内存大小=1Mb字节 + 扩展内存(K) * 1024 字节
 	memory_end &= 0xfffff000;					// 忽略不到4Kb(1页)的内存数
@@ -199,6 +210,7 @@ void main(void) /* This really IS void, no error here. */
 	 */
 	// pause() 系统调用（kernel / sched.c, 144）会把任务 0 转换成可中断等待状态，再执行调度函数。
 	// 但是调度函数只要发现系统中没有其它任务可以运行时就会切换到任务 0，而不依赖于任务 0 的状态。
+	// 这时 sys_pause() 会让 CPU 停机(hlt)等待中断，而不是马上返回这里空转。
 	// 主进程空闲时执行pause， 主动发起调度查询空闲的线程并执行
 	for (;;)
 		pause();
@@ -250,6 +262,9 @@ void init(void)
 	printf("%d buffers = %d bytes buffer space\n\r", NR_BUFFERS,
 		   NR_BUFFERS * BLOCK_SIZE);
 	printf("Free mem: %d bytes\n\r", memory_end - main_memory_start);
+	// jiffies 从 sched_init() 开始计数，即 main() 取得引导时间戳之后
+	printf("Boot: loader %d ms, kernel %d ms\n\r", loader_ms,
+		   jiffies * (1000 / HZ));
 	// 执行fork 创建子进程(任务2)
 	if (!(pid = fork())) // 子进程执行操作
 	{
@@ -1,5 +1,7 @@
 #ifndef _BLK_H
 #define _BLK_H
+
+#include <linux/trace.h>	/* end_request() and INIT_REQUEST are traced */
 /**
  * @brief 块设备数量
  */
@@ -43,7 +45,7 @@ struct request
     unsigned long sector;           //< 起始扇区(1块=2扇区)
     unsigned long nr_sectors;       //< 读/写扇区
     char *buffer;                   //< 读写数据缓冲区
-    struct task_struct *waiting;    //< 等待IO操作的任务
+    struct wait_queue *waiting;     //< 等待IO操作的任务
     struct buffer_head *bh;         //< 缓冲区头指针(include/linux/fs.h)
     struct request *next;           //< 指向下一项请求项
 };
@@ -86,7 +88,7 @@ extern struct request request[NR_REQUEST];
  * @brief 等待中的任务队列
  * 指针指向当前正在等待中的任务队列
  */
-extern struct task_struct * wait_for_request;
+extern struct wait_queue * wait_for_request;
 #define MAJOR_NR 3
 /**
  * @brief 定义主设备号
@@ -188,6 +190,7 @@ extern inline void unlock_buffer(struct buffer_head * bh)
  */
 extern inline void end_request(int uptodate)
 {
+	trace(TRACE_BLK_DONE, CURRENT->dev | (uptodate << 16), CURRENT->sector);
 	// 关闭当前设备
 	DEVICE_OFF(CURRENT->dev);
 	// 存在当前缓冲区
@@ -206,8 +209,12 @@ extern inline void end_request(int uptodate)
 	}
 	// 唤醒等待进程
 	wake_up(&CURRENT->waiting);
-	// 唤醒等待请求的进程
-	wake_up(&wait_for_request);
+	// 唤醒等待请求的进程。等待者是独占的，一个空闲项只唤醒一个；
+	// 但后 1/3 的请求项只能用于读，写请求用不上，这时全部唤醒让读请求有机会取得它
+	if (CURRENT < request + ((NR_REQUEST * 2) / 3))
+		wake_up(&wait_for_request);
+	else
+		wake_up_all(&wait_for_request);
 	// 重置设备符号
 	// 释放该项请求
 	CURRENT->dev = -1; 
@@ -216,6 +223,7 @@ extern inline void end_request(int uptodate)
 }
 /**
  * @brief 初始化等待任务队列
+ * 驱动程序确定了真正要发出的请求之后自己记录 TRACE_BLK_START(硬盘还要先轮换两个盘的请求)
  */
 #define INIT_REQUEST \
 repeat: \
@@ -34,6 +34,7 @@
 #include <linux/fs.h>
 #include <linux/kernel.h>
 #include <linux/fdreg.h>
+#include <linux/hrtimer.h>
 #include <asm/system.h>
 #include <asm/io.h>
 #include <asm/segment.h>
@@ -47,6 +48,26 @@ static int seek = 0;
 
 extern unsigned char current_DOR;
 
+/*
+ * fd_timer delays the start of a transfer until the motor is up to
+ * speed, or the newly selected drive has settled. It is initialised
+ * once in floppy_init(): it may still be queued when fd_delay() is
+ * called again, so only its function is changed here.
+ */
+static struct hrtimer fd_timer;
+
+static void fd_timer_callback(unsigned long fn)
+{
+	((void (*)(void)) fn)();
+}
+
+static void fd_delay(unsigned long long when, void (*fn)(void))
+{
+	hrtimer_cancel(&fd_timer);
+	fd_timer.data = (unsigned long) fn;
+	hrtimer_start(&fd_timer, when);
+}
+
 #define immoutb_p(val,port) \
 __asm__("outb %0,%1\n\tjmp 1f\n1:\tjmp 1f\n1:"::"a" ((char) (val)),"i" (port))
 
@@ -120,7 +141,30 @@ static unsigned char seek_track = 0;
 static unsigned char current_track = 255;
 static unsigned char command = 0;
 unsigned char selected = 0;
-struct task_struct * wait_on_floppy_select = NULL;
+
+/*
+ * Track buffer. A read miss reads the whole track (one head, sectors
+ * 1..sect) in one command, and later reads of blocks on that track are
+ * copied from memory without touching the drive. Writes go to the disk
+ * as before and update the buffered copy when they succeed.
+ *
+ * The DMA controller can't cross a 64kB boundary, so we reserve twice
+ * the largest track and use whichever half doesn't straddle one. It is
+ * in the kernel image, so it's well below 1MB.
+ */
+#define MAX_TRACK_SECT 18
+static char track_area[2*512*MAX_TRACK_SECT];
+static char * track_buffer = NULL;
+static int buffer_drive = -1;
+static unsigned char buffer_track = 0;
+static unsigned char buffer_head = 0;
+static struct floppy_struct * buffer_type = NULL;
+static int read_track = 0;		/* current command reads a whole track */
+static unsigned char req_sector = 0;	/* first sector of the block, from 0 */
+
+#define BUFFER_HIT(drive) (buffer_drive == (drive) && buffer_type == floppy && \
+	buffer_track == seek_track && buffer_head == head)
+struct wait_queue * wait_on_floppy_select = NULL;
 
 void floppy_deselect(unsigned int nr)
 {
@@ -145,6 +189,8 @@ repeat:
 	if ((current_DOR & 3) != nr)
 		goto repeat;
 	if (inb(FD_DIR) & 0x80) {
+		if (buffer_drive == nr)
+			buffer_drive = -1;
 		floppy_off(nr);
 		return 1;
 	}
@@ -160,9 +206,13 @@ __asm__("cld ; rep ; movsl" \
 static void setup_DMA(void)
 {
 	long addr = (long) CURRENT->buffer;
+	long count = BLOCK_SIZE - 1;
 
 	cli();
-	if (addr >= 0x100000) {
+	if (read_track) {
+		addr = (long) track_buffer;
+		count = floppy->sect * 512 - 1;
+	} else if (addr >= 0x100000) {
 		addr = (long) tmp_floppy_area;
 		if (command == FD_WRITE)
 			copy_buffer(CURRENT->buffer,tmp_floppy_area);
@@ -183,9 +233,9 @@ static void setup_DMA(void)
 /* bits 16-19 of addr */
 	immoutb_p(addr,0x81);
 /* low 8 bits of count-1 (1024-1=0x3ff) */
-	immoutb_p(0xff,5);
+	immoutb_p(count,5);
 /* high 8 bits of count-1 */
-	immoutb_p(3,5);
+	immoutb_p(count >> 8,5);
 /* activate DMA 2 */
 	immoutb_p(0|2,10);
 	sti();
@@ -232,6 +282,7 @@ static int result(void)
 
 static void bad_flp_intr(void)
 {
+	buffer_drive = -1;
 	CURRENT->errors++;
 	if (CURRENT->errors > MAX_ERRORS) {
 		floppy_deselect(current_drive);
@@ -259,8 +310,16 @@ static void rw_interrupt(void)
 		do_fd_request();
 		return;
 	}
-	if (command == FD_READ && (unsigned long)(CURRENT->buffer) >= 0x100000)
+	if (read_track) {
+		buffer_drive = current_drive;
+		buffer_track = seek_track;
+		buffer_head = head;
+		buffer_type = floppy;
+		copy_buffer(track_buffer + req_sector*512,CURRENT->buffer);
+	} else if (command == FD_READ && (unsigned long)(CURRENT->buffer) >= 0x100000)
 		copy_buffer(tmp_floppy_area,CURRENT->buffer);
+	else if (command == FD_WRITE && BUFFER_HIT(current_drive))
+		copy_buffer(CURRENT->buffer,track_buffer + req_sector*512);
 	floppy_deselect(current_drive);
 	end_request(1);
 	do_fd_request();
@@ -409,7 +468,7 @@ static void floppy_on_interrupt(void)
 		current_DOR &= 0xFC;
 		current_DOR |= current_drive;
 		outb(current_DOR,FD_DOR);
-		add_timer(2,&transfer);
+		fd_delay(hr_now() + MSEC_NS(20),&transfer);
 	} else
 		transfer();
 }
@@ -417,6 +476,7 @@ static void floppy_on_interrupt(void)
 void do_fd_request(void)
 {
 	unsigned int block;
+	unsigned long long when;
 
 	seek = 0;
 	if (reset) {
@@ -428,10 +488,8 @@ void do_fd_request(void)
 		return;
 	}
 	INIT_REQUEST;
+	trace(TRACE_BLK_START, CURRENT->dev, CURRENT->sector);
 	floppy = (MINOR(CURRENT->dev)>>2) + floppy_type;
-	if (current_drive != CURRENT_DEV)
-		seek = 1;
-	current_drive = CURRENT_DEV;
 	block = CURRENT->sector;
 	if (block+2 > floppy->size) {
 		end_request(0);
@@ -442,21 +500,50 @@ void do_fd_request(void)
 	head = block % floppy->head;
 	track = block / floppy->head;
 	seek_track = track << floppy->stretch;
+	req_sector = sector;
+	read_track = 0;
+	if (CURRENT->cmd == READ) {
+		command = FD_READ;
+/* blocks that run into the next track, and retries, bypass the buffer */
+		if (track_buffer && sector+1 < floppy->sect && !CURRENT->errors) {
+			if (BUFFER_HIT(CURRENT_DEV)) {
+				copy_buffer(track_buffer + sector*512,CURRENT->buffer);
+				end_request(1);
+				goto repeat;
+			}
+			read_track = 1;
+			sector = 0;
+		}
+	} else if (CURRENT->cmd == WRITE) {
+		command = FD_WRITE;
+		if (buffer_drive == CURRENT_DEV && sector+1 >= floppy->sect)
+			buffer_drive = -1;
+	} else
+		panic("do_fd_request: unknown command");
+	if (current_drive != CURRENT_DEV)
+		seek = 1;
+	current_drive = CURRENT_DEV;
 	if (seek_track != current_track)
 		seek = 1;
 	sector++;
-	if (CURRENT->cmd == READ)
-		command = FD_READ;
-	else if (CURRENT->cmd == WRITE)
-		command = FD_WRITE;
+	if ((when = floppy_on_time(current_drive)))
+		fd_delay(when,&floppy_on_interrupt);
 	else
-		panic("do_fd_request: unknown command");
-	add_timer(ticks_to_floppy_on(current_drive),&floppy_on_interrupt);
+		floppy_on_interrupt();
 }
 
 void floppy_init(void)
 {
+	unsigned long start = (unsigned long) track_area;
+	unsigned long end = start + 512*MAX_TRACK_SECT;
+
+/* use the first half, or start at the 64kB boundary it crosses */
+	if (!((start ^ (end-1)) & ~0xffff))
+		track_buffer = track_area;
+	else
+		track_buffer = (char *) ((end-1) & ~0xffff);
 	blk_dev[MAJOR_NR].request_fn = DEVICE_REQUEST;
+	hrtimer_init(&fd_timer, fd_timer_callback, 0);
 	set_trap_gate(0x26,&floppy_interrupt);
 	outb(inb_p(0x21)&~0x40,0x21);
 }
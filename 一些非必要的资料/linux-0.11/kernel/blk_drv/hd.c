@@ -16,6 +16,7 @@
 /*      
 * 本程序是底层硬盘中断辅助程序。主要用于扫描请求列表，使用中断在函数之间跳转。      
 * 由于所有的函数都是在中断里调用的，所以这些函数不可以睡眠。请特别注意。      
+* 中断处理程序只应答驱动器，read_intr() 等处理函数在中断的下半部(hd_bh())中开着中断执行。
 * 由 Drew Eckhardt 修改，利用 CMOS 信息检测硬盘数。     
 */
 #include <linux/config.h>
@@ -23,9 +24,13 @@
 #include <linux/fs.h>
 #include <linux/kernel.h>
 #include <linux/hdreg.h>
+#include <linux/hrtimer.h>
+#include <linux/interrupt.h>
+#include <linux/mm.h>
 #include <asm/system.h>
 #include <asm/io.h>
 #include <asm/segment.h>
+#include <asm/div64.h>
 
 
 // 定义硬件相关类型定义
@@ -42,11 +47,30 @@ inb_p(0x71); \
 /* Max read/write errors/sector */
 #define MAX_ERRORS	7   // 读写一个扇区时允许的最多出错次数
 #define MAX_HD		2  // 系统支持的最多硬盘数量
+#define HD_TIMEOUT	SEC_NS(6)	// 命令发出后等待中断的最长时间
 
 /**
  * @brief 硬盘中断程序在复位操作时会调用的重新校正函数(287 行)。
  */
 static void recal_intr(void);
+/**
+ * @brief 用 IDENTIFY 命令读取驱动器参数(sys_setup() 中使用)
+ */
+static int hd_identify(int drive, unsigned short * id);
+/**
+ * @brief 用 SET MULTIPLE 命令设置多扇区模式(sys_setup() 中使用)
+ */
+static int hd_set_multiple(int drive, int count);
+/**
+ * @brief 命令超时定时器，每发出一个命令重新启动
+ */
+static struct hrtimer hd_timer;
+
+/**
+ * @brief 硬盘中断次数和传输的扇区数，由 show_stat() 显示
+ */
+static unsigned long hd_intr_count = 0;
+static unsigned long hd_sect_count = 0;
 /**
  * @brief  重新校正标志
  * 将磁头移动到0 柱面
@@ -58,6 +82,11 @@ static int recalibrate = 1;
  * 来进行复位硬盘和控制器
  */
 static int reset = 1;
+/**
+ * @brief 复位后需要重新设置多扇区模式的硬盘(位图)
+ * 复位使驱动器退出多扇区模式，两个硬盘共用一个控制器，都要重新设置
+ */
+static int remultiple = 0;
 
 /*
  *  This struct defines the HD's and their types.
@@ -74,21 +103,23 @@ struct hd_i_struct
 	int wpcom; // 写前预补偿柱面号
 	int lzone; // 磁头着陆区柱面号
 	int ctl;   // 控制字节
+	int lba;   // 是否支持LBA 寻址(由 IDENTIFY 得到)，1 - LBA28，2 - 另外支持 LBA48
+	int mult;  // 多扇区模式每次中断传输的扇区数(SET MULTIPLE 设置)，0 - 不使用
 };
 #ifdef HD_TYPE
 struct hd_i_struct hd_info[] = { HD_TYPE };
 // 计算硬盘个数
 #define NR_HD ((sizeof (hd_info))/(sizeof (struct hd_i_struct))) 
 #else
-struct hd_i_struct hd_info[] = { {0,0,0,0,0,0},{0,0,0,0,0,0} };
+struct hd_i_struct hd_info[] = { {0,0,0,0,0,0,0,0},{0,0,0,0,0,0,0,0} };
 static int NR_HD = 0;
 #endif
 /**
  * @brief 定义硬盘描述结构数组
  */
 static struct hd_struct {
-	long start_sect; //< 起始扇区号
-	long nr_sects;  // 扇区总数
+	unsigned long start_sect; //< 起始扇区号
+	unsigned long nr_sects;  // 扇区总数
 } hd[5*MAX_HD]={{0,0},};
 /**
  * @brief 数据读取
@@ -104,6 +135,44 @@ __asm__("cld;rep;insw"::"d" (port),"D" (buf),"c" (nr):"cx","di")
 #define port_write(port,buf,nr) \
 __asm__("cld;rep;outsw"::"d" (port),"S" (buf),"c" (nr):"cx","si")
 
+/*
+ * PCI bus-master IDE (PIIX and compatibles). When a controller is found
+ * the transfer of a whole request is done by the controller from a PRD
+ * table, with one interrupt at the end, instead of one 'rep insw' and
+ * one interrupt per sector. Drives that refuse the DMA commands fall
+ * back to PIO.
+ */
+/**
+ * @brief PCI 配置空间地址/数据端口(配置机制 1)
+ */
+#define PCI_CONF_ADDR	0xcf8
+#define PCI_CONF_DATA	0xcfc
+
+/**
+ * @brief 物理区域描述符(PRD)
+ * 描述一段物理地址连续、不跨 64KB 边界的内存，count 为 0 表示 64KB，
+ * flags 位 15 置位表示表中最后一项
+ */
+struct prd {
+	unsigned long addr;
+	unsigned short count;
+	unsigned short flags;
+};
+#define PRD_EOT 0x8000
+
+/**
+ * @brief 总线主控寄存器基址(I/O 端口)，0 表示没有可用的 DMA 控制器
+ */
+static unsigned int bmide = 0;
+/**
+ * @brief PRD 表，占用一页内存(页对齐，不会跨 64KB 边界)
+ */
+static struct prd * prd_table = NULL;
+/**
+ * @brief 各硬盘是否使用 DMA 传输，DMA 命令出错后清零改用 PIO
+ */
+static int hd_dma[MAX_HD] = {0, 0};
+
 /**
  * @brief 硬盘中断处理函数
  * system_call.s，221 行）
@@ -133,6 +202,7 @@ int sys_setup(void * BIOS)
 	unsigned char cmos_disks;
 	struct partition *p;
 	struct buffer_head * bh;
+	unsigned short id[256];
 	// 始化时 callable=1，当运行该函数时将其设置为 0，使本函数只能执行一次。
 	if (!callable)
 		return -1;
@@ -198,6 +268,54 @@ int sys_setup(void * BIOS)
 	* 类型字节，使用 CMOS 中 0x1A 字节作为驱动器 2 的类型字节。      
 	* 总之，一个非零值意味着我们有一个 AT 控制器硬盘兼容的驱动器。      
 	*/
+	// 先用 IDENTIFY 询问驱动器本身，能应答的盘以它报告的参数为准，
+	// 不再受 BIOS 参数表的 CHS 范围限制；第一个盘不应答(如老式 ST-506)时
+	// 才按原来的方式查询 CMOS
+	for (drive = 0 ; drive < MAX_HD ; drive++) {
+		if (hd_identify(drive, id))
+			break;
+		hd_info[drive].cyl = id[1];
+		hd_info[drive].head = id[3];
+		hd_info[drive].sect = id[6];
+		if (!hd_info[drive].ctl && hd_info[drive].head > 8)
+			hd_info[drive].ctl = 8;
+		hd[drive*5].start_sect = 0;
+		hd[drive*5].nr_sects = hd_info[drive].head*
+				hd_info[drive].sect*hd_info[drive].cyl;
+		hd_info[drive].lba = 0;
+		if (id[49] & 0x200) {
+			// 字 60-61 为 LBA28 可寻址的扇区总数
+			hd_info[drive].lba = 1;
+			hd[drive*5].nr_sects = id[60] | ((unsigned long) id[61] << 16);
+			// 字 83 位 10 表示支持 LBA48，字 100-103 为总扇区数，这里只用低 32 位
+			if (id[83] & 0x400) {
+				hd_info[drive].lba = 2;
+				if (id[102] || id[103])
+					hd[drive*5].nr_sects = 0xffffffff;
+				else
+					hd[drive*5].nr_sects = id[100] |
+						((unsigned long) id[101] << 16);
+			}
+		}
+		// 字 47 低字节为多扇区命令一次可传输的最大扇区数
+		hd_info[drive].mult = 0;
+		if ((i = id[47] & 0xff) > 1) {
+			if (i > 16)
+				i = 16;
+			if (!hd_set_multiple(drive, i))
+				hd_info[drive].mult = i;
+		}
+		printk("hd%d: %lu sectors, %s, multiple %d\n\r", drive,
+			hd[drive*5].nr_sects,
+			hd_info[drive].lba == 2 ? "LBA48" :
+			hd_info[drive].lba ? "LBA28" : "CHS",
+			hd_info[drive].mult);
+	}
+#ifndef HD_TYPE
+	if (drive)
+		NR_HD = drive;
+	else
+#endif
 	// 检测硬盘是否为AT 控制器兼容
 	if ((cmos_disks = CMOS_READ(0x12)) & 0xf0)
 		if (cmos_disks & 0x0f)
@@ -299,7 +417,9 @@ static void hd_out(unsigned int drive,unsigned int nsect,unsigned int sect,
 	// 检查控制器是否就绪
 	if (!controller_ready())
 		panic("HD controller not ready");
-	// 设置磁盘中断响应
+	// 设置磁盘中断响应。先重新启动定时器：下半部开着中断，先设 do_hd 的话，
+	// 上一个命令的定时器可能在这中间到期，把新命令当作超时
+	hrtimer_start(&hd_timer, hr_now() + HD_TIMEOUT);
 	do_hd = intr_addr;
 	
 	// 向控制寄存器输出控制字节
@@ -316,6 +436,90 @@ static void hd_out(unsigned int drive,unsigned int nsect,unsigned int sect,
 	// 执行控制命令
 	outb(cmd,++port);
 }
+/**
+ * @brief  以LBA 方式向硬盘控制器发送命令块
+ * 扇区号超出 LBA28 范围时改用 LBA48：先写入各寄存器的高字节，
+ * 再写低字节，并把读写命令换成对应的 EXT 命令
+ * @param  drive            硬盘号(0-1)
+ * @param  nsect            读写扇区数目
+ * @param  block            起始绝对扇区号
+ * @param  cmd              命令码(WIN_READ/WIN_WRITE/WIN_READDMA/WIN_WRITEDMA)
+ * @param  intr_addr        硬中断处理调用函数
+ */
+static void hd_lba_out(unsigned int drive,unsigned int nsect,unsigned long block,
+		unsigned int cmd,void (*intr_addr)(void))
+{
+	register int port asm("dx");
+
+	if (drive>1)
+		panic("Trying to write bad sector");
+	if (!controller_ready())
+		panic("HD controller not ready");
+	hrtimer_start(&hd_timer, hr_now() + HD_TIMEOUT);
+	do_hd = intr_addr;
+	outb_p(hd_info[drive].ctl,HD_CMD);
+	port=HD_DATA;
+	if (block + nsect > LBA28_LIMIT && hd_info[drive].lba == 2) {
+		// LBA48：每个寄存器先写高字节(HOB)再写低字节，扇区号只用到低 32 位
+		outb_p(0,++port);
+		outb_p(nsect>>8,++port);
+		outb_p(block>>24,++port);
+		outb_p(0,++port);
+		outb_p(0,++port);
+		port=HD_DATA;
+		outb_p(0,++port);
+		outb_p(nsect,++port);
+		outb_p(block,++port);
+		outb_p(block>>8,++port);
+		outb_p(block>>16,++port);
+		outb_p(0xE0|(drive<<4),++port);
+		switch (cmd) {
+			case WIN_READ: cmd = WIN_READ_EXT; break;
+			case WIN_WRITE: cmd = WIN_WRITE_EXT; break;
+			case WIN_READDMA: cmd = WIN_READDMA_EXT; break;
+			case WIN_WRITEDMA: cmd = WIN_WRITEDMA_EXT; break;
+			case WIN_MULTREAD: cmd = WIN_MULTREAD_EXT; break;
+			case WIN_MULTWRITE: cmd = WIN_MULTWRITE_EXT; break;
+		}
+		outb(cmd,++port);
+		return;
+	}
+	// LBA28：扇区号低 24 位放在扇区号和柱面号寄存器中，高 4 位放在驱动器/磁头寄存器
+	outb_p(hd_info[drive].wpcom>>2,++port);
+	outb_p(nsect,++port);
+	outb_p(block,++port);
+	outb_p(block>>8,++port);
+	outb_p(block>>16,++port);
+	outb_p(0xE0|(drive<<4)|((block>>24)&0x0f),++port);
+	outb(cmd,++port);
+}
+/**
+ * @brief  向硬盘发出读写命令
+ * 支持 LBA 的硬盘直接使用绝对扇区号，否则按 BIOS/IDENTIFY 给出的几何参数换算成 CHS
+ * @param  drive            硬盘号(0-1)
+ * @param  nsect            读写扇区数目
+ * @param  block            起始绝对扇区号
+ * @param  cmd              命令码
+ * @param  intr_addr        硬中断处理调用函数
+ */
+static void hd_rw_out(unsigned int drive,unsigned int nsect,unsigned long block,
+		unsigned int cmd,void (*intr_addr)(void))
+{
+	unsigned int sec,head,cyl;
+
+	if (hd_info[drive].lba) {
+		hd_lba_out(drive,nsect,block,cmd,intr_addr);
+		return;
+	}
+	// 计算扇区号、柱面号
+	// 磁头号
+	__asm__("divl %4":"=a" (block),"=d" (sec):"0" (block),"1" (0),
+		"r" (hd_info[drive].sect));
+	__asm__("divl %4":"=a" (cyl),"=d" (head):"0" (block),"1" (0),
+		"r" (hd_info[drive].head));
+	sec++;
+	hd_out(drive,nsect,sec,head,cyl,cmd,intr_addr);
+}
 /**
  * @brief 等待硬盘就绪
  * 也即循环等待主状态控制器忙标志位复位。若仅有就绪或寻道结束标志
@@ -369,7 +573,7 @@ static void reset_hd(int nr)
 /**
  * @brief 意外硬盘中断调用函数。     
  * 发生意外硬盘中断时，硬盘中断处理程序中调用的默认C 处理函数。在被调用函数指针为空时     
- * 调用该函数。参见(kernel/system_call.s,241 行)。
+ * 调用该函数。参见 hd_intr()。
  */
 void unexpected_hd_interrupt(void)
 {
@@ -389,12 +593,88 @@ static void bad_rw_intr(void)
 	if (CURRENT->errors > MAX_ERRORS/2)
 		reset = 1;
 }
+/**
+ * @brief 等待下半部 hd_bh() 执行的处理函数，由 hd_intr() 或 hd_times_out() 设置
+ */
+static void (*hd_deferred)(void) = NULL;
+
+/**
+ * @brief  硬盘中断的上半部，由 kernel/system_call.s 中的 hd_interrupt 在关中断时调用
+ * 读状态寄存器应答驱动器，把处理函数交给下半部。读写数据和开始下一个请求都在下半部
+ * 开着中断进行，不会挡住串口等其他中断
+ * @param  handler          中断前 do_hd 的值，为空表示意外中断
+ */
+void hd_intr(void (*handler)(void))
+{
+	(void) inb_p(HD_STATUS);
+	// 上一次的处理还没有执行时来的只能是意外中断，不能把它覆盖掉
+	if (!hd_deferred)
+		hd_deferred = handler ? handler : unexpected_hd_interrupt;
+	mark_bh(HD_BH);
+}
+
+/**
+ * @brief  硬盘的下半部：执行登记的处理函数
+ */
+static void hd_bh(void)
+{
+	void (*handler)(void);
+
+	cli();
+	handler = hd_deferred;
+	hd_deferred = NULL;
+	sti();
+	if (handler)
+		handler();
+}
+
+/**
+ * @brief  超时处理的下半部：复位控制器后重做当前请求，并计一次错误
+ */
+static void hd_timeout(void)
+{
+	printk("HD timeout\n\r");
+	if (bmide)
+		outb(inb(bmide + BM_COMMAND) & ~BM_CMD_START, bmide + BM_COMMAND);
+	reset = 1;
+	if (!CURRENT)
+		return;
+	bad_rw_intr();
+	do_hd_request();
+}
+
+/**
+ * @brief  命令超时：驱动器一直没有发出中断，由定时器在关中断时调用
+ * 命令已经正常结束时 do_hd 为空，不做处理；否则取走 do_hd，此后再来的中断按意外
+ * 中断处理，复位交给下半部 hd_timeout()
+ * @param  unused           未使用
+ */
+static void hd_times_out(unsigned long unused)
+{
+	if (!do_hd)
+		return;
+	do_hd = NULL;
+	if (!hd_deferred)
+		hd_deferred = hd_timeout;
+	mark_bh(HD_BH);
+}
+/**
+ * @brief 本次中断(一个扇区组)传输的扇区数
+ * 多扇区模式下驱动器每 mult 个扇区中断一次，最后一组可以不足 mult 个
+ */
+#define CHUNK(dev) ((hd_info[dev].mult && CURRENT->nr_sectors > 1) ? \
+	(CURRENT->nr_sectors < hd_info[dev].mult ? \
+	CURRENT->nr_sectors : hd_info[dev].mult) : 1)
+
 /**
  * @brief 硬盘读取中断处理函数
  * 
  */
 static void read_intr(void)
 {
+	int n;
+
+	hd_intr_count++;
 	// 1. 判断原有处理是否出错
 	if (win_result()) {
 		// 进行失败处理
@@ -403,19 +683,21 @@ static void read_intr(void)
 		do_hd_request();
 		return;
 	}
-	// 尝试读取数据
-	port_read(HD_DATA,CURRENT->buffer,256);
+	n = CHUNK(CURRENT_DEV);
+	// 还没有读完时先设置 do_hd：这里开着中断，数据端口一读空驱动器就会为下一个
+	// 扇区组发出中断，这时 do_hd 必须已经指向 read_intr
+	if (CURRENT->nr_sectors > n)
+		do_hd = &read_intr;
+	// 读取一个扇区组的数据
+	port_read(HD_DATA,CURRENT->buffer,256*n);
+	hd_sect_count += n;
 	CURRENT->errors = 0;
-	CURRENT->buffer += 512;
+	CURRENT->buffer += 512*n;
 	// 增加起始扇区号
-	CURRENT->sector++;
-	// 检查是否读取完目标函数
-	if (--CURRENT->nr_sectors) {
-		// 没有读取完成
-		// 再次进行调用读取
-		do_hd = &read_intr;
+	CURRENT->sector += n;
+	// 检查是否读取完目标函数，没有读完就等下一个中断
+	if (CURRENT->nr_sectors -= n)
 		return;
-	}
 	// 结束此次请求
 	end_request(1);
 	// 处理下一个读取
@@ -426,21 +708,27 @@ static void read_intr(void)
  */
 static void write_intr(void)
 {
+	int n;
+
+	hd_intr_count++;
 	if (win_result()) {
 		bad_rw_intr();
 		do_hd_request();
 		return;
 	}
+	// 刚写完的扇区组大小
+	n = CHUNK(CURRENT_DEV);
+	hd_sect_count += n;
 	// 存在剩余的操作
-	if (--CURRENT->nr_sectors) {
+	if (CURRENT->nr_sectors -= n) {
 		// 指向下一块扇区
-		CURRENT->sector++;
+		CURRENT->sector += n;
 		// 增加缓冲区
-		CURRENT->buffer += 512;
+		CURRENT->buffer += 512*n;
 		// 设置操作具柄--循环进行操作
 		do_hd = &write_intr;
 		// 继续写入
-		port_write(HD_DATA,CURRENT->buffer,256);
+		port_write(HD_DATA,CURRENT->buffer,256*CHUNK(CURRENT_DEV));
 		return;
 	}
 	// 结束处理
@@ -448,6 +736,190 @@ static void write_intr(void)
 	// 调用下一个
 	do_hd_request();
 }
+/**
+ * @brief  以查询方式向驱动器发出一条不传输数据或只读一个扇区的命令
+ * 只在 sys_setup() 中使用，此时还没有请求在进行。通过设备控制寄存器的 nIEN 位
+ * 屏蔽驱动器中断，避免进入 unexpected_hd_interrupt()
+ * @param  drive            硬盘号(0-1)
+ * @param  nsect            扇区数寄存器的值
+ * @param  cmd              命令码
+ * @param  id               不为空时在 DRQ 置位后读出 256 字数据
+ * @return int              0 - 成功，1 - 驱动器不存在或命令出错
+ */
+static int hd_poll_cmd(int drive, int nsect, int cmd, unsigned short * id)
+{
+	int i, stat = 0, ret = 1;
+
+	outb_p(hd_info[drive].ctl | 0x02,HD_CMD);
+	outb_p(0xA0|(drive<<4),HD_CURRENT);
+	for (i = 0 ; i < 10000 ; i++)
+		if (!((stat = inb_p(HD_STATUS)) & BUSY_STAT))
+			break;
+	// 不存在的驱动器读出的状态为 0 或 0xff
+	if ((stat & (BUSY_STAT|READY_STAT)) != READY_STAT)
+		goto out;
+	outb_p(nsect,HD_NSECTOR);
+	outb_p(cmd,HD_COMMAND);
+	for (i = 0 ; i < 100000 ; i++) {
+		stat = inb_p(HD_STATUS);
+		if (!(stat & BUSY_STAT) && (!id || (stat & (DRQ_STAT|ERR_STAT))))
+			break;
+	}
+	if (stat & (BUSY_STAT|ERR_STAT))
+		goto out;
+	if (id) {
+		if (!(stat & DRQ_STAT))
+			goto out;
+		port_read(HD_DATA,id,256);
+	}
+	ret = 0;
+out:
+	outb_p(hd_info[drive].ctl & ~0x02,HD_CMD);
+	(void) inb_p(HD_STATUS);
+	return ret;
+}
+/**
+ * @brief  用 IDENTIFY 命令读取驱动器的 256 字参数
+ */
+static int hd_identify(int drive, unsigned short * id)
+{
+	return hd_poll_cmd(drive, 0, WIN_IDENTIFY, id);
+}
+/**
+ * @brief  设置多扇区模式：之后 READ/WRITE MULTIPLE 每 count 个扇区才中断一次
+ */
+static int hd_set_multiple(int drive, int count)
+{
+	return hd_poll_cmd(drive, count, WIN_SETMULT, NULL);
+}
+/**
+ * @brief  读 PCI 配置空间的一个双字
+ * @param  bus              总线号
+ * @param  dev              设备号
+ * @param  fn               功能号
+ * @param  reg              寄存器偏移(4 字节对齐)
+ * @return unsigned long    寄存器内容
+ */
+static unsigned long pci_conf_read(int bus, int dev, int fn, int reg)
+{
+	outl(0x80000000 | (bus<<16) | (dev<<11) | (fn<<8) | (reg & 0xfc),
+		PCI_CONF_ADDR);
+	return inl(PCI_CONF_DATA);
+}
+
+/**
+ * @brief  写 PCI 配置空间的一个双字
+ */
+static void pci_conf_write(int bus, int dev, int fn, int reg, unsigned long v)
+{
+	outl(0x80000000 | (bus<<16) | (dev<<11) | (fn<<8) | (reg & 0xfc),
+		PCI_CONF_ADDR);
+	outl(v, PCI_CONF_DATA);
+}
+
+/**
+ * @brief  在 PCI 总线 0 上寻找支持总线主控的 IDE 控制器，并为它准备 PRD 表
+ * 类代码 0x0101 且编程接口位 7 置位的设备即为总线主控 IDE，
+ * BAR4 给出主、从通道总线主控寄存器的 I/O 基址，这里只用主通道
+ */
+static void hd_dma_init(void)
+{
+	int dev, fn, i;
+	unsigned long v;
+
+	for (dev = 0 ; dev < 32 ; dev++)
+		for (fn = 0 ; fn < 8 ; fn++) {
+			v = pci_conf_read(0, dev, fn, 0x00);
+			if ((v & 0xffff) == 0xffff)
+				continue;
+			v = pci_conf_read(0, dev, fn, 0x08);
+			if ((v >> 16) != 0x0101 || !(v & 0x8000))
+				continue;
+			v = pci_conf_read(0, dev, fn, 0x20);
+			if (!(v & 1))
+				continue;
+			// 打开 I/O 空间访问和总线主控(命令寄存器位 0、2)
+			pci_conf_write(0, dev, fn, 0x04,
+				pci_conf_read(0, dev, fn, 0x04) | 0x05);
+			if (!(prd_table = (struct prd *) get_free_page()))
+				return;
+			bmide = v & 0xfff0;
+			// 此时 sys_setup() 尚未确定硬盘数，先对所有硬盘打开
+			for (i = 0 ; i < MAX_HD ; i++)
+				hd_dma[i] = 1;
+			printk("hd: bus-master DMA at 0x%04x\n\r", bmide);
+			return;
+		}
+}
+
+/**
+ * @brief  为从 buf 开始的 len 字节建立 PRD 表
+ * 内核空间是一一映射的，缓冲区的线性地址就是物理地址；
+ * 每一项不能跨越 64KB 边界，因此在边界处拆开
+ * @param  buf              缓冲区地址
+ * @param  len              字节数
+ */
+static void build_prd(char * buf, unsigned long len)
+{
+	struct prd * p = prd_table;
+	unsigned long addr = (unsigned long) buf, n;
+
+	while (len) {
+		n = 0x10000 - (addr & 0xffff);
+		if (n > len)
+			n = len;
+		p->addr = addr;
+		p->count = n & 0xffff;
+		p->flags = 0;
+		addr += n;
+		len -= n;
+		p++;
+	}
+	(p-1)->flags = PRD_EOT;
+}
+
+/**
+ * @brief DMA 传输结束中断处理函数
+ * 整个请求只在这里进入一次。停止总线主控并清除其中断/错误位，
+ * 出错(如驱动器不支持 DMA 命令)时关闭该盘的 DMA，按 PIO 方式重做本请求，
+ * 之后的错误由 PIO 路径按 MAX_ERRORS 计数处理
+ */
+static void dma_intr(void)
+{
+	int stat = inb(bmide + BM_STATUS);
+
+	hd_intr_count++;
+	outb(inb(bmide + BM_COMMAND) & ~BM_CMD_START, bmide + BM_COMMAND);
+	outb(stat | BM_STAT_ERR | BM_STAT_INTR, bmide + BM_STATUS);
+	if (win_result() || (stat & BM_STAT_ERR)) {
+		hd_dma[CURRENT_DEV] = 0;
+		printk("hd%d: DMA failed, using PIO\n\r", CURRENT_DEV);
+		do_hd_request();
+		return;
+	}
+	hd_sect_count += CURRENT->nr_sectors;
+	end_request(1);
+	do_hd_request();
+}
+
+/**
+ * @brief  显示硬盘中断统计：中断次数、传输扇区数以及每读写 1MB 的中断次数
+ * 由 show_stat()(kernel/sched.c) 调用
+ */
+void hd_show_stat(void)
+{
+	unsigned long long n;
+
+	printk("hd: %lu interrupts, %lu sectors", hd_intr_count, hd_sect_count);
+	if (hd_sect_count) {
+		// 中断次数超过 2M 次后乘 2048 会溢出 32 位
+		n = (unsigned long long) hd_intr_count * 2048;
+		do_div(n, hd_sect_count);
+		printk(", %lu interrupts/MB", (unsigned long) n);
+	}
+	printk("\n\r");
+}
+
 /**
  * @brief 磁盘矫正复位
  * 在硬盘中断处理程序中被调用。
@@ -460,6 +932,59 @@ static void recal_intr(void)
 	do_hd_request();
 }
 
+/**
+ * @brief 复位后重新设置多扇区模式的中断处理函数
+ * 设置失败时该盘改为每个扇区中断一次，以免 CHUNK() 与驱动器不一致
+ */
+static void setmult_intr(void)
+{
+	if (win_result()) {
+		printk("hd%d: SET MULTIPLE failed after reset\n\r", CURRENT_DEV);
+		hd_info[CURRENT_DEV].mult = 0;
+	}
+	do_hd_request();
+}
+
+/*
+ * Both drives hang off the same channel and share one set of task file
+ * registers, so only one command can be outstanding at a time. What we
+ * can do is keep one drive from starving the other: the elevator sorts
+ * the queue by device, so without this a copy from hd0 to hd1 would
+ * read all of hd0's requests before writing any of hd1's.
+ */
+/**
+ * @brief 上一个命令所用的硬盘号
+ */
+static int last_drive = 0;
+
+/**
+ * @brief  在两个硬盘之间轮流选择下一个请求
+ * 如果队首请求与上一个命令属于同一硬盘，而队列中有另一硬盘的请求，
+ * 就把第一个这样的请求移到队首。队首请求在此时还没有发出命令，可以移动。
+ * 出错重试(errors 不为 0，部分传输后出错的请求也是这样)以及复位、重新校正
+ * 之前不换，重试总是针对出错的那个请求
+ */
+static void hd_pick_request(void)
+{
+	struct request ** p, * req;
+	unsigned long flags;
+
+	if (NR_HD < 2 || DEVICE_NR(CURRENT->dev) != last_drive)
+		return;
+	if (CURRENT->errors || reset || recalibrate)
+		return;
+	save_flags(flags);
+	cli();
+	for (p = &CURRENT->next ; (req = *p) ; p = &req->next)
+		if (DEVICE_NR(req->dev) != last_drive) {
+			*p = req->next;
+			req->next = CURRENT;
+			CURRENT = req;
+			break;
+		}
+	restore_flags(flags);
+}
+
 /**
  * @brief 执行硬盘读写请求操作。     
  * 若请求项是块设备的第 1 个，则块设备当前请求项指针（参见 ll_rw_blk.c，28 行）会直接指向该请求项，
@@ -470,11 +995,14 @@ static void recal_intr(void)
 void do_hd_request(void)
 {
 	int i,r;
-	unsigned int block,dev;
-	unsigned int sec,head,cyl;
+	unsigned int dev;
+	unsigned long block;
 	unsigned int nsect;
 	//  初始化请求，没有就直接退出
 	INIT_REQUEST;
+	// 两个硬盘的请求轮流处理
+	hd_pick_request();
+	trace(TRACE_BLK_START, CURRENT->dev, CURRENT->sector);
 	// 取设备号中的子设备号--硬盘分区号
 	dev = MINOR(CURRENT->dev);
 	block = CURRENT->sector;
@@ -487,19 +1015,14 @@ void do_hd_request(void)
 	block += hd[dev].start_sect;
 	// 重新计算设备号
 	dev /= 5;
-	// 计算扇区号、柱面号
-	// 磁头号
-	__asm__("divl %4":"=a" (block),"=d" (sec):"0" (block),"1" (0),
-		"r" (hd_info[dev].sect));
-	__asm__("divl %4":"=a" (cyl),"=d" (head):"0" (block),"1" (0),
-		"r" (hd_info[dev].head));
-	sec++;
+	last_drive = dev;
 	// 需要读写的扇区总数
 	nsect = CURRENT->nr_sectors;
 	// 需要重置
 	if (reset) {
 		reset = 0;
 		recalibrate = 1;
+		remultiple = (1 << NR_HD) - 1;
 		reset_hd(CURRENT_DEV);
 		return;
 	}
@@ -510,9 +1033,33 @@ void do_hd_request(void)
 			WIN_RESTORE,&recal_intr);
 		return;
 	}	
+	// 复位后驱动器不再是多扇区模式，开始读写之前重新设置
+	if (remultiple & (1 << dev)) {
+		remultiple &= ~(1 << dev);
+		if (hd_info[dev].mult) {
+			hd_out(dev,hd_info[dev].mult,0,0,0,WIN_SETMULT,&setmult_intr);
+			return;
+		}
+	}
+	// 控制器支持总线主控时整个请求交给 DMA，只在结束时中断一次
+	if (bmide && hd_dma[dev]) {
+		if (CURRENT->cmd != READ && CURRENT->cmd != WRITE)
+			panic("unknown hd-command");
+		build_prd(CURRENT->buffer, nsect << 9);
+		outb(0, bmide + BM_COMMAND);
+		outl((unsigned long) prd_table, bmide + BM_PRD);
+		outb(inb(bmide + BM_STATUS) | BM_STAT_ERR | BM_STAT_INTR,
+			bmide + BM_STATUS);
+		outb((CURRENT->cmd == READ) ? BM_CMD_READ : 0, bmide + BM_COMMAND);
+		hd_rw_out(dev,nsect,block,
+			(CURRENT->cmd == READ) ? WIN_READDMA : WIN_WRITEDMA, &dma_intr);
+		outb(inb(bmide + BM_COMMAND) | BM_CMD_START, bmide + BM_COMMAND);
+		return;
+	}
 	// 写扇区
 	if (CURRENT->cmd == WRITE) {
-		hd_out(dev,nsect,sec,head,cyl,WIN_WRITE,&write_intr);
+		hd_rw_out(dev,nsect,block,
+			hd_info[dev].mult ? WIN_MULTWRITE : WIN_WRITE,&write_intr);
 		// 如果请求服务 DRQ 置位则退出循环。若等到循环结束也没有置位，则表示此次写硬盘操作失败，去
 		// 处理下一个硬盘请求。否则向硬盘控制器数据寄存器端口 HD_DATA 写入 1 个扇区的数据。
 		for(i=0 ; i<3000 && !(r=inb_p(HD_STATUS)&DRQ_STAT) ; i++)
@@ -521,11 +1068,12 @@ void do_hd_request(void)
 			bad_rw_intr();
 			goto repeat; // 继续重复执行
 		}
-		// 执行写操作
-		port_write(HD_DATA,CURRENT->buffer,256);
+		// 执行写操作，多扇区模式下先写入第一个扇区组
+		port_write(HD_DATA,CURRENT->buffer,256*CHUNK(dev));
 	} else if (CURRENT->cmd == READ) {
 		// 执行读操作
-		hd_out(dev,nsect,sec,head,cyl,WIN_READ,&read_intr);
+		hd_rw_out(dev,nsect,block,
+			hd_info[dev].mult ? WIN_MULTREAD : WIN_READ,&read_intr);
 	} else
 		panic("unknown hd-command");
 }
@@ -533,7 +1081,10 @@ void do_hd_request(void)
 void hd_init(void)
 {
 	blk_dev[MAJOR_NR].request_fn = DEVICE_REQUEST; // 设置硬盘系统调用中断
+	hrtimer_init(&hd_timer, hd_times_out, 0);
+	init_bh(HD_BH, hd_bh);
 	set_intr_gate(0x2E,&hd_interrupt);  // 设置硬盘中断门向量 int 0x2E
 	outb_p(inb_p(0x21) & 0xfb, 0x21);	//  复位接联的主8259A int2的屏蔽位，允许从片发出中断请求信号。
 	outb(inb_p(0xA1) & 0xbf, 0xA1);		//  复位硬盘的中断请求屏蔽位（在从片上），允许硬盘控制器发送中断请求信号。
+	hd_dma_init();                      //  探测 PCI 总线主控 IDE 控制器
 }
@@ -10,6 +10,7 @@
 #include <errno.h>
 #include <linux/sched.h>
 #include <linux/kernel.h>
+#include <linux/trace.h>
 #include <asm/system.h>
 
 #include "blk.h"
@@ -40,7 +41,7 @@ struct request request[NR_REQUEST];
  * 当无空闲进程项目时进行等待
  * 这里只有一个，多个等待会出现问题？？？？
  */
-struct task_struct * wait_for_request = NULL;
+struct wait_queue * wait_for_request = NULL;
 
 /* blk_dev_struct is:
  *	do_request-address
@@ -103,6 +104,7 @@ static void add_request(struct blk_dev_struct * dev, struct request * req)
 	struct request * tmp;
 	// 
 	req->next = NULL;
+	trace(TRACE_BLK_QUEUE, req->dev, req->sector);
 	cli();
 	// 存在缓冲区
 	if (req->bh)
@@ -189,7 +191,7 @@ while (--req >= request)
 			unlock_buffer(bh);
 			return;
 		}
-		sleep_on(&wait_for_request); // 进行睡眠，之后再次进行等待
+		sleep_on_exclusive(&wait_for_request); // 独占睡眠，释放一项只唤醒一个等待者
 		goto repeat;
 	}
 /* fill up the request-info, and add it to the queue */
@@ -218,6 +220,13 @@ void ll_rw_block(int rw, struct buffer_head * bh)
 	// 主设备号
 	unsigned int major;
 
+	// 直接映射的虚拟盘块不需要读写：数据本来就在虚拟盘上。free_block() 会清掉
+	// b_uptodate，这里重新置上，否则 bread() 会当作读错误
+	if (rd_mapped(bh)) {
+		bh->b_dirt = 0;
+		bh->b_uptodate = 1;
+		return;
+	}
 	if ((major=MAJOR(bh->b_dev)) >= NR_BLK_DEV ||
 	!(blk_dev[major].request_fn)) {
 		printk("Trying to read nonexistent block-device\n\r");
@@ -35,6 +35,7 @@
 #include <linux/sched.h>
 #include <linux/fs.h>
 #include <linux/kernel.h>
+#include <linux/lzss.h>
 #include <asm/system.h>
 #include <asm/segment.h>
 #include <asm/memory.h>
@@ -45,6 +46,53 @@
 char	*rd_start;  // 虚拟盘在内存中的起始位置，在52行初始化函数 rd_init()中确定
 int	rd_length = 0;   // 虚拟盘所占内存大小(子节)
 
+/*
+ * The ram disk is already in memory, so there is no point in keeping a
+ * second copy of its blocks in the buffer cache. Every block gets its
+ * own buffer head, kept right after the ram disk, whose b_data points
+ * straight into rd_start. get_hash_table() hands these out for
+ * /dev/ram, so reads and writes go to the ram disk memory directly.
+ */
+/**
+ * @brief 虚拟盘各块的缓冲头数组，第 n 项对应第 n 块
+ */
+static struct buffer_head * rd_heads = NULL;
+
+/**
+ * @brief  取虚拟盘块 block 的缓冲头(直接映射到虚拟盘内存)
+ * 由 get_hash_table()(fs/buffer.c) 调用，引用计数加 1。
+ * 数据总是最新的，写入即已写到虚拟盘上，因此不需要读写请求
+ * @param  dev              设备号
+ * @param  block            块号
+ * @return struct buffer_head*  缓冲头，不是虚拟盘或越界时返回 NULL
+ */
+struct buffer_head * rd_getblk(int dev, int block)
+{
+	struct buffer_head * bh;
+
+	if (dev != 0x0101 || !rd_heads || block < 0 ||
+	    block >= (rd_length >> BLOCK_SIZE_BITS))
+		return NULL;
+	bh = rd_heads + block;
+	if (!bh->b_data) {
+		bh->b_data = rd_start + (block << BLOCK_SIZE_BITS);
+		bh->b_dev = dev;
+		bh->b_blocknr = block;
+		bh->b_uptodate = 1;
+	}
+	bh->b_count++;
+	return bh;
+}
+
+/**
+ * @brief  缓冲块是否直接映射在虚拟盘内存上
+ */
+int rd_mapped(struct buffer_head * bh)
+{
+	return rd_heads && bh >= rd_heads &&
+		bh < rd_heads + (rd_length >> BLOCK_SIZE_BITS);
+}
+
 /**
  * @brief
  * 虚拟盘当前请求项操作函数。程序结构与do_hd_request()类似(hd.c,294)。    
@@ -61,6 +109,7 @@ void do_rd_request(void)
 	char	*addr;
 
 	INIT_REQUEST;
+	trace(TRACE_BLK_START, CURRENT->dev, CURRENT->sector);
 	addr = rd_start + (CURRENT->sector << 9);
 	len = CURRENT->nr_sectors << 9;
 	if ((MINOR(CURRENT->dev) != 1) || (addr+len > rd_start+rd_length)) {
@@ -97,14 +146,93 @@ long rd_init(long mem_start, int length)
 {
 	int	i;
 	char	*cp;
+	long	size;
 
 	blk_dev[MAJOR_NR].request_fn = DEVICE_REQUEST; // do_rd_request()。
 	rd_start = (char *) mem_start;  // 对于 16MB 系统，该值为 4MB。 
 	rd_length = length;
+	if (!length)
+		return 0;
+	// 虚拟盘之后紧接着存放各块的缓冲头，总大小按页对齐
+	rd_heads = (struct buffer_head *) (rd_start + length);
+	size = length + (length >> BLOCK_SIZE_BITS) * sizeof(struct buffer_head);
+	size = (size + 4095) & ~4095;
 	cp = rd_start;
-	for (i=0; i < length; i++)
+	for (i=0; i < size; i++)
 		*cp++ = '\0';
-	return(length);
+	return(size);
+}
+
+/*
+ * Input side of the compressed loader: hands lzss_decode() one byte at a
+ * time from the boot floppy, reading ahead a couple of blocks.
+ */
+/**
+ * @brief 压缩映像读取状态：当前缓冲块、下一个要读的块号、块内位置、剩余字节数
+ */
+static struct buffer_head * rdz_bh = NULL;
+static int rdz_block;
+static int rdz_pos;
+static long rdz_left;
+
+/**
+ * @brief  取压缩数据流的下一个字节，供 lzss_decode() 调用
+ * @return int              字节值，数据读完或读盘出错返回 -1
+ */
+static int rdz_getb(void)
+{
+	if (rdz_left <= 0)
+		return -1;
+	if (rdz_pos >= BLOCK_SIZE) {
+		brelse(rdz_bh);
+		if (!(rdz_bh = breada(ROOT_DEV, rdz_block, rdz_block+1,
+		    rdz_block+2, -1))) {
+			printk("I/O error on block %d, aborting load\n", rdz_block);
+			return -1;
+		}
+		rdz_block++;
+		rdz_pos = 0;
+		printk("\010\010\010\010\010%4dk", rdz_block - 256);
+	}
+	rdz_left--;
+	return (unsigned char) rdz_bh->b_data[rdz_pos++];
+}
+
+/**
+ * @brief  加载压缩的根文件系统映像
+ * 块 256 以 rdz_header 开头时调用。边读软盘边解压到虚拟盘，
+ * 读盘量只有压缩后的大小
+ * @param  bh               块 256 的缓冲块，由本函数释放
+ * @return int              1 - 加载成功，0 - 失败
+ */
+static int rd_load_compressed(struct buffer_head * bh)
+{
+	struct rdz_header * h = (struct rdz_header *) bh->b_data;
+	long n;
+
+	if (h->size > rd_length) {
+		printk("Ram disk image too big!  (%d bytes, %d avail)\n",
+			h->size, rd_length);
+		brelse(bh);
+		return 0;
+	}
+	printk("Loading %d bytes (%d compressed) into ram disk... 0000k",
+		h->size, h->zsize);
+	rdz_bh = bh;
+	rdz_block = 257;
+	rdz_pos = sizeof(struct rdz_header);
+	rdz_left = h->zsize;
+	n = lzss_decode(rd_start, h->size, rdz_getb);
+	if (n != h->size) {
+		printk("\nRam disk image corrupt, aborting load\n");
+		n = -1;
+	}
+	brelse(rdz_bh);
+	rdz_bh = NULL;
+	if (n < 0)
+		return 0;
+	printk("\010\010\010\010\010done \n");
+	return 1;
 }
 
 /*
@@ -139,6 +267,17 @@ void rd_load(void)
 	// 非软盘直接退出
 	if (MAJOR(ROOT_DEV) != 2)
 		return;
+	// 块 256 以压缩头开始时按压缩映像加载
+	if (!(bh = breada(ROOT_DEV, block, block + 1, block + 2, -1))) {
+		printk("Disk error while looking for ramdisk!\n");
+		return;
+	}
+	if (((struct rdz_header *) bh->b_data)->magic == RDZ_MAGIC) {
+		if (rd_load_compressed(bh))
+			ROOT_DEV=0x0101;
+		return;
+	}
+	brelse(bh);
 	// 读软盘块 256 + 1, 256, 256 + 2。breada() 用于读取指定的数据块，并标出还需要读的块，然后返回 
 	// 含有数据块的缓冲区指针。如果返回 NULL，则表示数据块不可读(fs/buffer.c,322)。     
 	// 这里 block+1 是指磁盘上的超级块。
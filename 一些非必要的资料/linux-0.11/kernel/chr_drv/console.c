@@ -76,6 +76,10 @@ static unsigned short	video_erase_char;	/* Char+Attrib to erase with	*/
 // 以下变量用于屏幕卷屏操作
 static unsigned long	origin;		/* Used for EGA/VGA fast scroll	*/
 static unsigned long	scr_end;	/* Used for EGA/VGA fast scroll	*/
+// 显示控制器中当前实际的起始地址和光标位置。con_write()一批字符处理完之后
+// 才与 origin/pos 比较并写入硬件，避免每次卷屏、每个字符都去写 CRTC 寄存器
+static unsigned long	hw_origin;
+static unsigned long	hw_pos;
 static unsigned long	pos;  // 综合位置
 static unsigned long	x,y;  // 当前光标位置
 static unsigned long	top,bottom;  // 滚动时顶行行号
@@ -106,6 +110,7 @@ static inline void gotoxy(unsigned int new_x,unsigned int new_y)
 // 设置滚屏起始显示内存地址。
 static inline void set_origin(void)
 {
+	hw_origin = origin;
 	cli();
 	outb_p(12, video_port_reg);
 	outb_p(0xff&((origin-video_mem_start)>>9), video_port_val);
@@ -147,7 +152,7 @@ static void scrup(void)
 					"D" (scr_end-video_size_row)
 					:"cx","di");
 			}
-			set_origin();
+			// 起始地址寄存器留到 update_screen() 中统一设置
 		} else {
 			__asm__("cld\n\t"
 				"rep\n\t"
@@ -331,6 +336,7 @@ void csi_m(void)
 // 根据显示内存光标对应位置 pos，设置显示控制器光标的显示位置
 static inline void set_cursor(void)
 {
+	hw_pos = pos;
 	cli();
 	outb_p(14, video_port_reg);
 	outb_p(0xff&((pos-video_mem_start)>>9), video_port_val);
@@ -338,6 +344,15 @@ static inline void set_cursor(void)
 	outb_p(0xff&((pos-video_mem_start)>>1), video_port_val);
 	sti();
 }
+// 一批字符处理完毕后，把软件维护的起始地址和光标位置同步到显示控制器。
+// 连续输出多行时，只需一次写 CRTC 寄存器，而不是每行、每次调用都写
+static inline void update_screen(void)
+{
+	if (origin != hw_origin)
+		set_origin();
+	if (pos != hw_pos)
+		set_cursor();
+}
 //// 发送对终端 VT100 的响应序列。     
 // 将响应序列放入读缓冲队列中。
 static void respond(struct tty_struct * tty)
@@ -487,6 +502,18 @@ void con_write(struct tty_struct * tty)
 						:"ax");
 					pos += 2;
 					x++;
+					// 连续的可显示字符直接批量写入显存，
+					// 直到行尾或遇到控制字符，不再逐个经过状态机
+					while (nr && x<video_num_columns) {
+						c = tty->write_q.buf[tty->write_q.tail];
+						if (c<=31 || c>=127)
+							break;
+						INC(tty->write_q.tail);
+						nr--;
+						*(unsigned short *)pos = (attr<<8) | (unsigned char) c;
+						pos += 2;
+						x++;
+					}
 				} else if (c==27)
 					state=1;
 				else if (c==10 || c==11 || c==12)
@@ -624,8 +651,8 @@ void con_write(struct tty_struct * tty)
 				}
 		}
 	}
-    // 最后根据上面设置的光标位置，向显示器发送光标显示位置
-	set_cursor();
+    // 最后根据上面设置的起始地址和光标位置，统一更新显示控制器
+	update_screen();
 }
 
 /*
@@ -686,7 +713,9 @@ void con_init(void)
 		if ((ORIG_VIDEO_EGA_BX & 0xff) != 0x10)
 		{
 			video_type = VIDEO_TYPE_EGAC;
-			video_mem_end = 0xbc000;
+			// EGA/VGA 彩色文本模式映射 0xb8000-0xbffff 共 32KB，
+			// 用满整个窗口可使卷屏回绕(整屏拷贝)的次数减半
+			video_mem_end = 0xc0000;
 			display_desc = "EGAc";
 		}
 		else
@@ -714,6 +743,8 @@ void con_init(void)
 	bottom	= video_num_lines;
 
 	gotoxy(ORIG_X,ORIG_Y);
+	hw_origin = origin;
+	hw_pos = pos;
 	set_trap_gate(0x21,&keyboard_interrupt);
 	outb_p(inb_p(0x21)&0xfd,0x21);
 	a=inb_p(0x61);
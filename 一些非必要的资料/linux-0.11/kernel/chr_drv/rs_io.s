@@ -26,7 +26,7 @@ size	= 1024				/* must be power of two !
 rs_addr = 0
 head = 4  // head
 tail = 8 // 尾部
-proc_list = 12 // 等待缓冲队列指针
+proc_list = 12 // 等待队列头指针(struct wait_queue *)
 buf = 16  // 队列缓冲区
                     /* 写队列可写剩余字符空间长度 */
 startup	= 256		/* chars left in write queue when we restart it */
@@ -63,7 +63,11 @@ rep_int:  // 中断处理核心函数
 	inb %dx,%al  // 取出中断标识字节，用以判断中断来源
 	testb $1,%al  // 判断有待处理的中断(位 =1 无中断，=0 有中断)
 	jne end  // 无中断直接结束
-	cmpb $6,%al		/* this shouldn't happen, but ... 检查al值大于6 */
+	andb $0x0e,%al		/* strip FIFO-enabled bits 7-6 */ /* 开启FIFO 后位 7-6 恒为 1 */
+	cmpb $0x0c,%al		/* rx FIFO timeout */ /* 接收FIFO 超时(有数据但未达触发深度)，按读字符处理 */
+	jne 1f
+	movb $4,%al
+1:	cmpb $6,%al		/* this shouldn't happen, but ... 检查al值大于6 */
 	ja end  // 直接跳出
 	movl 24(%esp),%ecx  // 将缓冲队列地址放入ecx
 	pushl %edx  // 将edx--中断标识寄存器端口号 0x3fa(0x2fa) 放入栈中
@@ -85,7 +89,10 @@ modem 状态发生变化；
 	jmp rep_int
 end:	movb $0x20,%al
 	outb %al,$0x20		/* EOI */
-	pop %ds
+	cmpl $0,_bh_active	// 开着中断执行下半部(kernel/softirq.c)，其中包括
+	je 1f			// copy_to_cooked()，这期间串口中断可以继续接收
+	call _do_bottom_half
+1:	pop %ds
 	pop %es
 	popl %eax
 	popl %ebx
@@ -115,23 +122,29 @@ line_status:
 	ret
 // 由于串行设备（芯片）接收到字符而引起这次中断。将接收到的字符放到读缓冲队列 read_q 头     
 // 指针（head）处，并且让该指针前移一个字符位置。若 head 指针已经到达缓冲区末端，则让其     
-// 折返到缓冲区开始处。最后调用 C 函数do_tty_interrupt()（也即 copy_to_cooked()），把读     
+// 折返到缓冲区开始处。最后调用 C 函数do_tty_interrupt() 登记下半部，由它调用 copy_to_cooked() 把读     
 // 入的字符经过一定处理放入规范模式缓冲队列（辅助缓冲队列secondary）中。
 .align 2
 read_char:
-	inb %dx,%al   // 读取字符 -> al
-	movl %ecx,%edx  // 当前串口缓冲队列指针地址 -> edx
-	subl $_table_list,%edx  // 缓冲队列指针表首地址 - 当前串口队列指针地址 -> edx
-	shrl $3,%edx   // 差值/8
+	pushl %ecx  // 保存当前串口缓冲队列指针地址，稍后用于计算串口号
 	movl (%ecx),%ecx		# read-queue // 读取缓冲队列第一个值
+1:	inb %dx,%al   // 读取字符 -> al
 	movl head(%ecx),%ebx  // ebx 指向缓冲区头部地址
 	movb %al,buf(%ecx,%ebx)  // 将读取到的字符，放在缓冲区头指针的位置
 	incl %ebx   // 将指针前移动一个字节
 	andl $size-1,%ebx   // 与运算，防止溢出 等价取余
 	cmpl tail(%ecx),%ebx  // 检查是否已经指向尾部
-	je 1f  // 是，直接结束，调用软中断函数
+	je 2f  // 是，队列已满丢弃该字符，但仍要把 FIFO 读空
 	movl %ebx,head(%ecx) // 否，重新修改头部指针
-1:	pushl %edx  // 将串口号压入堆栈(1 - 串口1，2 - 串口2)，作为参数
+2:	addl $5,%edx		/* line status reg */ // 读线路状态寄存器(0x3fd)
+	inb %dx,%al
+	subl $5,%edx
+	testb $1,%al		/* more data in rx FIFO? */ // 接收FIFO 中还有数据则继续读取，
+	jne 1b			// 一次中断取走全部已收到的字符
+	popl %edx  // 当前串口缓冲队列指针地址 -> edx
+	subl $_table_list,%edx  // 缓冲队列指针表首地址 - 当前串口队列指针地址 -> edx
+	shrl $3,%edx   // 差值/8
+	pushl %edx  // 将串口号压入堆栈(1 - 串口1，2 - 串口2)，作为参数
 	call _do_tty_interrupt  // 调用tty 中断处理C 函数()
 	addl $4,%esp  // 丢弃入栈参数，并返回
 	ret
@@ -144,6 +157,10 @@ read_char:
 // 把读入的字符经过一定处理放入规范模式缓冲队列(辅助缓冲队列secondary)中
 .align 2
 write_char:
+	movl %ecx,%ebx  // 由缓冲队列指针地址计算串口号(1 或 2)
+	subl $_table_list,%ebx
+	shrl $3,%ebx
+	movb _rs_fifo_size(,%ebx,4),%ah	/* chars the tx FIFO can take */ // 本次最多可连续写入的字符数
 	movl 4(%ecx),%ecx		# write-queue // 读取写缓冲队列地址 -> ecx
 	movl head(%ecx),%ebx   // 写队列头指针到ebx
 	subl tail(%ecx),%ebx  // 计算队列中字符数量 = 头指针 - 尾指针
@@ -151,10 +168,9 @@ write_char:
 	je write_buffer_empty  // 无字符，进入空字符串处理
 	cmpl $startup,%ebx    // 检查字符数量 > 256
 	ja 1f   // 超过，跳转进行处理，否则直接唤醒等待中的进程进行处理
-	movl proc_list(%ecx),%ebx	# wake up sleeping process  // 唤醒等待进程进行处理
-	testl %ebx,%ebx			# is there any?  // 检测是否有剩余
+	cmpl $0,proc_list(%ecx)	# anyone waiting?  // 检测是否有等待进程
 	je 1f  // 空，跳转1 处进行执行
-	movl $0,(%ebx)   // 将进程设置为可运行状态
+	call wake_writers  // 唤醒等待队列上的所有写进程
 1:	movl tail(%ecx),%ebx  // 获取尾部指针 -> ebx
 	movb buf(%ecx,%ebx),%al  // 从缓冲中尾部指针取一字符 -> al
 	outb %al,%dx  // 输出到保持寄存器中
@@ -163,15 +179,32 @@ write_char:
 	movl %ebx,tail(%ecx)  // 设置新的头部指针数据
 	cmpl head(%ecx),%ebx  // 到达头部，表示已经清空，进行跳转
 	je write_buffer_empty // 跳转至写入缓冲队列位空的情况
+	decb %ah		/* fill the whole tx FIFO */ // 发送FIFO 未填满则继续写入下一个字符
+	jne 1b
 	ret
+// 唤醒write_q 等待队列(ecx 指向写队列)上的进程：调用 C 函数 wake_up(&proc_list)。
+// eax(ah 为剩余 FIFO 计数)、ecx、edx 是 C 函数可能破坏的寄存器，调用前后保存。
+.align 2
+wake_writers:
+	pushl %eax
+	pushl %ecx
+	pushl %edx
+	leal proc_list(%ecx),%eax
+	pushl %eax
+	call _wake_up
+	addl $4,%esp
+	popl %edx
+	popl %ecx
+	popl %eax
+	ret
+
 // 处理写缓冲队列write_q已空的情况。若有等待写该串行终端的进程则唤醒之，然后屏蔽发送     
 // 保持寄存器空中断，不让发送保持寄存器空时产生中断。
 .align 2
 write_buffer_empty:
-	movl proc_list(%ecx),%ebx	# wake up sleeping process // 获取等待队列进程
-	testl %ebx,%ebx			# is there any?  // 检查是否位空
+	cmpl $0,proc_list(%ecx)	# anyone waiting?  // 检查是否有等待进程
 	je 1f  // 无，跳转到1
-	movl $0,(%ebx) // 有：将进程设置为可运行状态
+	call wake_writers  // 有：唤醒等待队列上的进程
 1:	incl %edx  // 指向端口 0x3f9(0x2f9)。
 	inb %dx,%al // 读取中断允许寄存器
 	jmp 1f  // 稍作延迟
@@ -34,12 +34,20 @@ extern void rs1_interrupt(void);
  */
 extern void rs2_interrupt(void);
 
+/**
+ * @brief 各串口发送FIFO 的深度，按 tty 号索引(1 - 串口1，2 - 串口2)
+ * rs_io.s 的 write_char 每次中断最多连续写入这么多字符。
+ * 16550A 为 16，没有可用 FIFO 的 8250/16450 为 1
+ */
+int rs_fifo_size[3] = {0, 1, 1};
+
 /**
  * @brief  初始化串行端口
  * 
  * @param  port     串行端口编号 0x3F8 和 0x2f8
+ * @return int      发送FIFO 深度
  */
-static void init(int port)
+static int init(int port)
 {
     // 设置线路控制寄存器 DLAB位
 	outb_p(0x80,port+3);	/* set DLAB of line control reg */
@@ -48,7 +56,14 @@ static void init(int port)
 	outb_p(0x03,port+3);	/* reset DLAB */
 	outb_p(0x0b,port+4);	/* set DTR,RTS, OUT_2 */
 	outb_p(0x0d,port+1);	/* enable all intrs but writes */
+	// 开启并清空收发FIFO，接收触发深度 8 字节：收满 8 个字符(或超时)才产生一次中断
+	outb_p(0x87,port+2);	/* enable FIFOs, clear them, rx trigger 8 */
 	(void)inb(port);	    /* read data port to reset things (?) */
+	// 中断标识寄存器位 7-6 同为 1 表明 FIFO 可用(16550A)，否则是 8250/16450
+	if ((inb_p(port+2) & 0xc0) == 0xc0)
+		return 16;
+	outb_p(0x00,port+2);
+	return 1;
 }
 /**
  * @brief 串口端口初始化
@@ -58,8 +73,8 @@ void rs_init(void)
     // 设置中断门向量，处理函数
 	set_intr_gate(0x24,rs1_interrupt);
 	set_intr_gate(0x23,rs2_interrupt);
-    init(tty_table[1].read_q.data); // 初始化串口 1(.data 是端口号)
-    init(tty_table[2].read_q.data); // 初始化串口 2 
+    rs_fifo_size[1] = init(tty_table[1].read_q.data); // 初始化串口 1(.data 是端口号)
+    rs_fifo_size[2] = init(tty_table[2].read_q.data); // 初始化串口 2 
 	outb(inb_p(0x21)&0xE7,0x21);    // 允许主8259A 芯片的IRQ3，IRQ4 中断请求
 }
 
@@ -80,7 +95,15 @@ void rs_init(void)
  */
 void rs_write(struct tty_struct * tty)
 {
+	int port = tty->write_q.data;
+
 	cli(); // 关闭中断
+	// 发送保持寄存器已空(线路状态寄存器位 5)时，直接送出队首字符启动发送，
+	// 省去一次"发送保持寄存器空"中断的往返，其余字符再由中断继续发送
+	if (!EMPTY(tty->write_q) && (inb_p(port+5) & 0x20)) {
+		outb(tty->write_q.buf[tty->write_q.tail],port);
+		INC(tty->write_q.tail);
+	}
 	// 检查写入队列是否为空
 	if (!EMPTY(tty->write_q))
 		// 不为空修改中断允许标志位，让串口设备允许字符写入产生的中断
@@ -88,6 +111,6 @@ void rs_write(struct tty_struct * tty)
 		// 1. 读起中断允许寄存器内容
 		// 2. 添加发送保持寄存器中断允许标志位
 		// 3. 重新进行写入
-		outb(inb_p(tty->write_q.data+1)|0x02,tty->write_q.data+1);
+		outb(inb_p(port+1)|0x02,port+1);
 	sti(); // 允许中断
 }
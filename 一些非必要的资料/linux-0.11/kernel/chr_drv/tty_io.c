@@ -13,6 +13,7 @@
 #include <ctype.h>
 #include <errno.h>
 #include <signal.h>
+#include <string.h>
 /**
  * @brief 下面给出相应信号在信号位图中的对应比特位置
  */
@@ -24,6 +25,7 @@
 
 #include <linux/sched.h>
 #include <linux/tty.h>
+#include <linux/interrupt.h>
 #include <asm/segment.h>
 #include <asm/system.h>
 /**
@@ -128,6 +130,28 @@ struct tty_queue * table_list[]={
  * @brief tty终端初始化函数
  * 初始化串口终端和控制台终端
  */
+/**
+ * @brief 收到了输入、等待 copy_to_cooked() 处理的终端位图
+ */
+static unsigned long tty_pending = 0;
+
+/**
+ * @brief  终端输入的下半部：对登记的终端执行 copy_to_cooked()
+ */
+static void tty_bh(void)
+{
+	unsigned long pending;
+	int i;
+
+	cli();
+	pending = tty_pending;
+	tty_pending = 0;
+	sti();
+	for (i = 0 ; pending ; i++, pending >>= 1)
+		if (pending & 1)
+			copy_to_cooked(tty_table+i);
+}
+
 void tty_init(void)
 {
 	/**
@@ -137,6 +161,7 @@ void tty_init(void)
 	 */
 	rs_init();
 	con_init();
+	init_bh(TTY_BH, tty_bh);
 }
 /**
  * @brief  进程中断处理函数
@@ -335,7 +360,7 @@ int tty_read(unsigned channel, char * buf, int nr)
 	if (time && !minimum) {
 		minimum=1;
 		if (flag=(!oldalarm || time+jiffies<oldalarm))
-			current->alarm = time+jiffies;
+			set_alarm(time+jiffies);
 	}
 	if (minimum>nr)
 		minimum=nr;
@@ -375,9 +400,9 @@ int tty_read(unsigned channel, char * buf, int nr)
 		// 如果超时定时值 time 不为 0 并且规范模式标志没有置位(非规范模式)，那么：
 		if (time && !L_CANON(tty))
 			if (flag=(!oldalarm || time+jiffies<oldalarm))
-				current->alarm = time+jiffies;
+				set_alarm(time+jiffies);
 			else
-				current->alarm = oldalarm;
+				set_alarm(oldalarm);
 		// 如果规范模式标志置位，那么若已读到起码一个字符则中断循环。否则若已读取数大于或等于最少要     
 		// 求读取的字符数，则也中断循环。
 		if (L_CANON(tty)) {
@@ -386,13 +411,58 @@ int tty_read(unsigned channel, char * buf, int nr)
 		} else if (b-buf >= minimum)
 			break;
 	}
-	current->alarm = oldalarm;
+	set_alarm(oldalarm);
 	if (current->signal && !(b-buf))
 		return -EINTR;
 	return (b-buf);
 }
+#define TTY_BULK 256	/* tty_write_bulk() 一次最多拷贝的字节数 */
+
+/**
+ * @brief  批量拷贝用户数据到写队列
+ * 用户数据先拷到本地缓冲区，再一次放入写队列：memcpy_fromfs() 可能因缺页而睡眠，
+ * 这期间别的写者可能已经用掉了写队列的空闲区，所以拷贝完成前不能占用它。
+ * 若开启了输出处理(OPOST)，先在用户空间找到需要转换的'\r'、'\n'，只拷贝其之前的
+ * 部分，该字符交给逐字节的慢速路径处理。
+ * @param  tty              指定终端
+ * @param  b                用户缓冲区指针
+ * @param  nr               剩余待写字节数
+ * @return int              已放入写队列的字节数
+ */
+static int tty_write_bulk(struct tty_struct * tty, char * b, int nr)
+{
+	struct tty_queue * q = &tty->write_q;
+	char buf[TTY_BULK], c;
+	int n, i;
+
+	n = LEFT(*q);
+	if (n > nr)
+		n = nr;
+	if (n > TTY_BULK)
+		n = TTY_BULK;
+	if (O_POST(tty))
+		for (i=0 ; i<n ; i++)
+			if ((c=get_fs_byte(b+i))=='\n' || c=='\r') {
+				n = i;
+				break;
+			}
+	if (n <= 0)
+		return 0;
+	memcpy_fromfs(buf, b, n);
+	// 从这里到提交不会再睡眠，但空闲区可能已经变小，重新检查
+	if (n > LEFT(*q))
+		n = LEFT(*q);
+	i = TTY_BUF_SIZE - q->head;
+	if (i > n)
+		i = n;
+	memcpy(q->buf + q->head, buf, i);
+	memcpy(q->buf, buf + i, n - i);
+	q->head = (q->head + n) & (TTY_BUF_SIZE-1);
+	return n;
+}
 /**
  * @brief  tty 写函数。把用户缓冲区中的字符写入 tty 的写队列中。
+ * 对不需要做输出转换的字符串，走 tty_write_bulk() 的批量拷贝路径
  * @param  channel          子设备号
  * @param  buf              缓冲区指针
  * @param  nr               写子节数目
@@ -403,6 +473,7 @@ int tty_write(unsigned channel, char * buf, int nr)
 	static cr_flag=0;
 	struct tty_struct * tty;
 	char c, *b=buf;
+	int n;
 
 	if (channel>2 || nr<0) return -1;
 	tty = channel + tty_table;
@@ -411,6 +482,20 @@ int tty_write(unsigned channel, char * buf, int nr)
 		if (current->signal)
 			break;
 		while (nr>0 && !FULL(tty->write_q)) {
+			// 大小写转换需要逐字节处理，其余情况先尝试批量拷贝，
+			// 批量路径停下的那个字符再走下面的逐字节转换
+			if (!O_POST(tty) || !O_LCUC(tty)) {
+				n = tty_write_bulk(tty,b,nr);
+				if (n > 0) {
+					b += n;
+					nr -= n;
+					cr_flag = 0;
+					continue;
+				}
+				// 读用户数据时可能睡眠，写队列可能已被别的写者填满
+				if (FULL(tty->write_q))
+					break;
+			}
 			c=get_fs_byte(b);
 			if (O_POST(tty)) {
 				if (c=='\r' && O_CRNL(tty))
@@ -436,6 +521,29 @@ int tty_write(unsigned channel, char * buf, int nr)
 	return (b-buf);
 }
 
+/**
+ * @brief  查询终端当前不睡眠即可处理的字符数
+ * 供 O_NONBLOCK 读写(fs/char_dev.c)和 select()/poll()(fs/select.c)使用
+ * @param  channel          子设备号
+ * @param  rw               READ 或 WRITE
+ * @return int              READ: 可读字符数(规范模式下没有完整的行时为 0)；
+ *                          WRITE: 写队列剩余空间的一半(输出处理可能把 NL 扩展为 CR-NL)
+ */
+int tty_ready(unsigned channel, int rw)
+{
+	struct tty_struct * tty;
+
+	if (channel>2)
+		return 0;
+	tty = channel + tty_table;
+	if (rw == READ) {
+		if (L_CANON(tty) && !tty->secondary.data)
+			return 0;
+		return CHARS(tty->secondary);
+	}
+	return LEFT(tty->write_q)>>1;
+}
+
 /*
  * Jeh, sometimes I really like the 386.
  * This routine is called from an interrupt,
@@ -454,9 +562,11 @@ int tty_write(unsigned channel, char * buf, int nr)
 // 参数：tty - 指定的 tty 终端号（0，1 或 2）。     
 // 将指定 tty 终端队列缓冲区中的字符复制成规范(熟)模式字符并存放在辅助队列(规范模式队列)中。     
 // 在串口读字符中断(rs_io.s, 109)和键盘中断(kerboard.S, 69)中调用。
+// 复制工作(包括回显)较慢，这里只登记，由下半部 tty_bh() 开着中断完成。
 void do_tty_interrupt(int tty)
 {
-	copy_to_cooked(tty_table+tty);
+	tty_pending |= 1 << tty;
+	mark_bh(TTY_BH);
 }
 
 void chr_dev_init(void)
@@ -40,10 +40,12 @@
 #include <asm/segment.h>
 #include <asm/system.h>
 //  这是波特率因子数组（或称为除数数组）。波特率与波特率因子的对应关系参见列表后的说明。
+// 后两项对应 CBAUDEX 扩展的 B57600、B115200。
 static unsigned short quotient[] = {
 	0, 2304, 1536, 1047, 857,
 	768, 576, 384, 192, 96,
-	64, 48, 24, 12, 6, 3
+	64, 48, 24, 12, 6, 3,
+	2, 1
 };
 /**
  * @brief 修改终端设置传送速度
@@ -52,12 +54,21 @@ static unsigned short quotient[] = {
 static void change_speed(struct tty_struct * tty)
 {
 	unsigned short port,quot;
+	unsigned long i;
 
 	if (!(port = tty->read_q.data))
 		return;
 	// 从 tty 的 termios 结构控制模式标志集中取得设置的波特率索引号，据此从波特率因子数组中取得     
 	// 对应的波特率因子值。CBAUD是控制模式标志集中波特率位屏蔽码。
-	quot = quotient[tty->termios.c_cflag & CBAUD];
+	// CBAUDEX 置位时表示 B38400 之后的扩展波特率，接在数组第 15 项之后
+	i = tty->termios.c_cflag & CBAUD;
+	if (i & CBAUDEX) {
+		i &= ~CBAUDEX;
+		if (i < 1 || i > 2)
+			return;
+		i += 15;
+	}
+	quot = quotient[i];
 	cli();
 	outb_p(0x80,port+3);		/* set DLAB */
 	outb_p(quot & 0xff,port);	/* LS of divisor */
@@ -151,6 +151,8 @@ static void tell_father(int pid)
 int do_exit(long code)
 {
 	int i;
+	// 停掉 ITIMER_REAL 的定时器
+	del_timer(&current->real_timer);
 	// 释放当前进程代码段和数据段所占用的内存页
 	free_page_tables(get_base(current->ldt[1]),get_limit(0x0f));
 	free_page_tables(get_base(current->ldt[2]),get_limit(0x17));
@@ -21,6 +21,7 @@
  * @param  address   目标地址可写
  */
 extern void write_verify(unsigned long address);
+extern void ret_from_fork(void);
 /**
  * @brief 最新进程号
  * 其值由 get_empty_process()生成。
@@ -123,6 +124,7 @@ int copy_process(int nr,long ebp,long edi,long esi,long gs,long none,
 	struct task_struct *p;
 	int i;
 	struct file *f;
+	long *stack;
 	// 分配内存结构
 	p = (struct task_struct *) get_free_page();
 	if (!p)
@@ -138,31 +140,46 @@ int copy_process(int nr,long ebp,long edi,long esi,long gs,long none,
 	p->counter = p->priority;
 	p->signal = 0;
 	p->alarm = 0;
+	p->timeout = 0;
+	// 间隔定时器不继承
+	init_timer(&p->real_timer, it_real_fn, (unsigned long) p);
+	p->it_real_incr = 0;
+	p->it_virt_value = p->it_virt_incr = 0;
+	p->it_prof_value = p->it_prof_incr = 0;
 	p->leader = 0;		/* process leadership doesn't inherit */
 	p->utime = p->stime = 0;
+	p->utime_ns = p->stime_ns = 0;
+	p->wake_tsc = 0;
+	p->prof_ticks = 0;
 	p->cutime = p->cstime = 0;
 	p->start_time = jiffies;  // 设置时钟
-	p->tss.back_link = 0;
-	p->tss.esp0 = PAGE_SIZE + (long) p; // 内核堆栈指针
-	p->tss.ss0 = 0x10;
-	p->tss.eip = eip;
-	p->tss.eflags = eflags;
-	p->tss.eax = 0;  // 注意：这里时fork 新进程会返回0 的原因
-	p->tss.ecx = ecx;
-	p->tss.edx = edx;
-	p->tss.ebx = ebx;
-	p->tss.esp = esp; // 复制父进程堆栈内容
-	p->tss.ebp = ebp;
-	p->tss.esi = esi;
-	p->tss.edi = edi;
-	p->tss.es = es & 0xffff;
-	p->tss.cs = cs & 0xffff;
-	p->tss.ss = ss & 0xffff;
-	p->tss.ds = ds & 0xffff;
-	p->tss.fs = fs & 0xffff;
-	p->tss.gs = gs & 0xffff;
-	p->tss.ldt = _LDT(nr);  // 设置新任务的局部描述符表的选择
-	p->tss.trace_bitmap = 0x80000000;
+	/*
+	 * 在新任务的内核栈上构造它第一次被 switch_to() 切换进来时用到的内容(自顶向下)：
+	 * 返回用户态的 ret_from_sys_call 栈帧(eax = 0，这就是子进程中 fork 返回 0 的原因)、
+	 * switch_stacks() 返回到的 ret_from_fork，以及它要恢复的 ebp、edi、esi、ebx、fs、gs。
+	 * 内核态的 fs 指向用户数据段，ret_from_sys_call 处理信号时要用它访问用户栈。
+	 */
+	stack = (long *) (PAGE_SIZE + (long) p);
+	*--stack = ss & 0xffff;
+	*--stack = esp;
+	*--stack = eflags;
+	*--stack = cs & 0xffff;
+	*--stack = eip;
+	*--stack = ds & 0xffff;
+	*--stack = es & 0xffff;
+	*--stack = fs & 0xffff;
+	*--stack = edx;
+	*--stack = ecx;
+	*--stack = ebx;
+	*--stack = 0;
+	*--stack = (long) ret_from_fork;
+	*--stack = ebp;
+	*--stack = edi;
+	*--stack = esi;
+	*--stack = ebx;
+	*--stack = 0x17;
+	*--stack = gs & 0xffff;
+	p->ksp = (long) stack;
 	/*
 		// 如果当前任务使用了协处理器，就保存其上下文。汇编指令 clts 用于清除控制寄存器 CR0 中的任务 
 		// 已交换（TS）标志。每当发生任务切换，CPU 都会设置该标志。该标志用于管理数学协处理器：如果     
@@ -192,8 +209,7 @@ int copy_process(int nr,long ebp,long edi,long esi,long gs,long none,
 		current->root->i_count++;
 	if (current->executable)
 		current->executable->i_count++;
-	// 设置GDT中的新任务TSS和LDT描述符
-	set_tss_desc(gdt+(nr<<1)+FIRST_TSS_ENTRY,&(p->tss));
+	// 设置GDT中的新任务LDT描述符(TSS 只有任务 0 的一个)
 	set_ldt_desc(gdt+(nr<<1)+FIRST_LDT_ENTRY,&(p->ldt));
 	// 将其设置为RUNNING
 	// 准备运行
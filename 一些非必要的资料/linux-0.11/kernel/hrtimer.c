@@ -0,0 +1,245 @@
+/*
+ *  linux/kernel/hrtimer.c
+ */
+
+/*
+ * 高精度定时器和 nanosleep() 系统调用。
+ *
+ * 时间由 hr_now()(kernel/sched.c)读 8253 计数器 0 得到，精度不到 1 微秒。8253 同时
+ * 产生时钟滴答，重新设置它会使 jiffies 计时不准，因此定时器到期的中断由 RTC 的周期
+ * 中断(IRQ8)产生：只有最早的定时器在下一个滴答之前到期时才打开它，其余情况由
+ * do_timer() 在滴答中处理。
+ *
+ * 等待中的定时器按到期时间排成一个有序链表，数量很少时这样最简单。
+ */
+
+#include <errno.h>
+#include <time.h>
+
+#include <linux/sched.h>
+#include <linux/kernel.h>
+#include <linux/hrtimer.h>
+#include <asm/system.h>
+#include <asm/segment.h>
+#include <asm/io.h>
+#include <asm/div64.h>
+
+#define RTC_REG_A	0x0a
+#define RTC_REG_B	0x0b
+#define RTC_REG_C	0x0c
+#define RTC_RATE_8192	0x03	/* 寄存器 A 的频率选择位：32768 >> (3 - 1) = 8192Hz */
+#define RTC_PIE		0x40	/* 寄存器 B：允许周期中断 */
+
+#define CMOS_READ(addr) ({ \
+outb_p(0x80|addr,0x70); \
+inb_p(0x71); \
+})
+
+#define CMOS_WRITE(val,addr) ({ \
+outb_p(0x80|addr,0x70); \
+outb_p(val,0x71); \
+})
+
+extern void rtc_interrupt(void);
+extern unsigned long next_tick_jiffies(void);
+
+static struct hrtimer * hr_head = NULL;
+static int rtc_on = 0;
+
+/**
+ * @brief  按最早的定时器打开或关闭 RTC 周期中断，调用者负责关中断
+ * 在下一个时钟中断之前到期时需要打开
+ */
+static void rtc_update(void)
+{
+	int on;
+
+	on = hr_head && hr_head->expires <
+		(unsigned long long) next_tick_jiffies() * NSEC_PER_JIFFY;
+	if (on == rtc_on)
+		return;
+	rtc_on = on;
+	CMOS_WRITE((CMOS_READ(RTC_REG_B) & ~RTC_PIE) | (on ? RTC_PIE : 0),
+		RTC_REG_B);
+}
+
+/**
+ * @brief  从链表中摘下定时器，调用者负责关中断
+ * @return int              1 - 定时器原来在等待，0 - 不在
+ */
+static int detach_hrtimer(struct hrtimer * timer)
+{
+	if (!timer->pprev)
+		return 0;
+	if (timer->next)
+		timer->next->pprev = timer->pprev;
+	*timer->pprev = timer->next;
+	timer->pprev = NULL;
+	return 1;
+}
+
+/**
+ * @brief  初始化定时器
+ * @param  timer            定时器
+ * @param  function         到期时调用的函数
+ * @param  data             传给 function 的参数
+ */
+void hrtimer_init(struct hrtimer * timer,
+	void (*function)(unsigned long), unsigned long data)
+{
+	timer->next = NULL;
+	timer->pprev = NULL;
+	timer->expires = 0;
+	timer->function = function;
+	timer->data = data;
+}
+
+/**
+ * @brief  (重新)启动定时器，已经在等待的先取消
+ * @param  timer            定时器
+ * @param  expires          到期时间(开机以来的纳秒数)
+ */
+void hrtimer_start(struct hrtimer * timer, unsigned long long expires)
+{
+	struct hrtimer ** p;
+	unsigned long flags;
+
+	save_flags(flags);
+	cli();
+	detach_hrtimer(timer);
+	timer->expires = expires;
+	for (p = &hr_head ; *p && (*p)->expires <= expires ; p = &(*p)->next)
+		/* nothing */ ;
+	if ((timer->next = *p))
+		(*p)->pprev = &timer->next;
+	*p = timer;
+	timer->pprev = p;
+	rtc_update();
+	restore_flags(flags);
+}
+
+/**
+ * @brief  取消定时器
+ * @param  timer            定时器
+ * @return int              1 - 定时器原来在等待，0 - 已经到期或没有启动
+ */
+int hrtimer_cancel(struct hrtimer * timer)
+{
+	unsigned long flags;
+	int ret;
+
+	save_flags(flags);
+	cli();
+	ret = detach_hrtimer(timer);
+	rtc_update();
+	restore_flags(flags);
+	return ret;
+}
+
+/**
+ * @brief  执行所有到期的定时器，在关中断的情况下由 do_timer() 和 RTC 中断调用
+ */
+void run_hrtimers(void)
+{
+	struct hrtimer * timer;
+	unsigned long long now = hr_now();
+
+	while ((timer = hr_head) && timer->expires <= now) {
+		detach_hrtimer(timer);
+		(timer->function)(timer->data);
+	}
+	rtc_update();
+}
+
+/**
+ * @brief  最早的定时器到期的那个滴答(jiffies 值)，空闲时用来限制时钟周期的长度
+ * @param  limit            没有更早的定时器时返回的值
+ * @return unsigned long    jiffies 值
+ */
+unsigned long next_hrtimer_jiffies(unsigned long limit)
+{
+	unsigned long long j;
+
+	if (!hr_head)
+		return limit;
+	j = hr_head->expires;
+	do_div(j, NSEC_PER_JIFFY);
+	if ((long) ((unsigned long) j - limit) < 0)
+		return (unsigned long) j;
+	return limit;
+}
+
+/**
+ * @brief  RTC 中断的 C 处理函数，由 kernel/system_call.s 中的 rtc_interrupt 调用
+ * 读寄存器 C 应答中断，然后执行到期的定时器
+ */
+void do_rtc(void)
+{
+	CMOS_READ(RTC_REG_C);
+	run_hrtimers();
+}
+
+/**
+ * @brief  设置 RTC 周期中断的频率和中断门，由 sched_init() 调用
+ * 周期中断平时是关闭的，见 rtc_update()
+ */
+void hrtimer_init_rtc(void)
+{
+	CMOS_WRITE((CMOS_READ(RTC_REG_A) & 0xf0) | RTC_RATE_8192, RTC_REG_A);
+	CMOS_WRITE(CMOS_READ(RTC_REG_B) & ~RTC_PIE, RTC_REG_B);
+	CMOS_READ(RTC_REG_C);
+	set_intr_gate(0x28, &rtc_interrupt);
+	outb_p(inb_p(0x21) & 0xfb, 0x21);	// 允许从片的级联中断 IRQ2
+	outb(inb_p(0xA1) & 0xfe, 0xA1);		// 允许 IRQ8
+}
+
+/**
+ * @brief  nanosleep() 的定时器处理函数：唤醒睡眠的任务
+ * @param  data             任务结构指针
+ */
+static void hrtimer_wakeup(unsigned long data)
+{
+	struct task_struct * p = (struct task_struct *) data;
+
+	if (p->state == TASK_INTERRUPTIBLE)
+		wake_up_process(p);
+}
+
+/**
+ * @brief  nanosleep 系统调用：睡眠指定的时间
+ * @param  rqtp             用户空间的睡眠时间
+ * @param  rmtp             不为空时，被信号中断后在这里返回剩余的时间
+ * @return int              0，被信号中断返回 -EINTR，时间不正确返回 -EINVAL
+ */
+int sys_nanosleep(struct timespec * rqtp, struct timespec * rmtp)
+{
+	struct hrtimer timer;
+	unsigned long long expires, left, now;
+	long sec, nsec;
+
+	sec = get_fs_long((unsigned long *) &rqtp->tv_sec);
+	nsec = get_fs_long((unsigned long *) &rqtp->tv_nsec);
+	if (sec < 0 || nsec < 0 || nsec >= NSEC_PER_SEC)
+		return -EINVAL;
+	expires = hr_now() + SEC_NS(sec) + nsec;
+	hrtimer_init(&timer, hrtimer_wakeup, (unsigned long) current);
+	hrtimer_start(&timer, expires);
+	for (;;) {
+		current->state = TASK_INTERRUPTIBLE;
+		if (!hrtimer_pending(&timer) || (current->signal & ~current->blocked))
+			break;
+		schedule();
+	}
+	current->state = TASK_RUNNING;
+	if (!hrtimer_cancel(&timer))
+		return 0;
+	if (rmtp) {
+		now = hr_now();
+		left = (expires > now) ? expires - now : 0;
+		nsec = do_div(left, NSEC_PER_SEC);
+		verify_area(rmtp, sizeof(*rmtp));
+		put_fs_long((unsigned long) left, (unsigned long *) &rmtp->tv_sec);
+		put_fs_long(nsec, (unsigned long *) &rmtp->tv_nsec);
+	}
+	return -EINTR;
+}
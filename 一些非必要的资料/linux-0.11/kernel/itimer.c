@@ -0,0 +1,222 @@
+/*
+ *  linux/kernel/itimer.c
+ */
+
+/*
+ * 进程的间隔定时器：setitimer()/getitimer() 以及 alarm()。
+ *
+ * ITIMER_REAL 按实际时间计时，用进程自己的定时器 real_timer(kernel/timer.c)，
+ * 到期时发 SIGALRM；current->alarm 是它下一次到期的 jiffies 值(0 表示没有启动)。
+ * ITIMER_VIRTUAL 和 ITIMER_PROF 只在进程运行时计时，由 do_timer() 递减。
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include <linux/sched.h>
+#include <linux/kernel.h>
+#include <linux/timer.h>
+#include <asm/segment.h>
+
+/**
+ * @brief  timeval 换算成滴答数，不足一个滴答的向上取整
+ */
+static unsigned long tvtojiffies(struct timeval * value)
+{
+	return value->tv_sec * HZ +
+		(value->tv_usec + (1000000/HZ) - 1) / (1000000/HZ);
+}
+
+/**
+ * @brief  滴答数换算成 timeval
+ */
+static void jiffiestotv(unsigned long jiffies, struct timeval * value)
+{
+	value->tv_sec = jiffies / HZ;
+	value->tv_usec = (jiffies % HZ) * (1000000/HZ);
+}
+
+/**
+ * @brief  ITIMER_REAL 到期：发 SIGALRM，有间隔时重新启动
+ * @param  data             任务结构指针
+ */
+void it_real_fn(unsigned long data)
+{
+	struct task_struct * p = (struct task_struct *) data;
+
+	p->signal |= (1 << (SIGALRM - 1));
+	if (p->it_real_incr) {
+		p->alarm += p->it_real_incr;
+		mod_timer(&p->real_timer, p->alarm);
+	} else
+		p->alarm = 0;
+}
+
+/**
+ * @brief  设置当前进程 ITIMER_REAL 的到期时间(不改变间隔)
+ * tty_read() 用它实现 VTIME 读超时
+ * @param  expires          到期的 jiffies 值，0 表示取消
+ */
+void set_alarm(long expires)
+{
+	current->alarm = expires;
+	if (expires)
+		mod_timer(&current->real_timer, expires);
+	else
+		del_timer(&current->real_timer);
+}
+
+/**
+ * @brief  取间隔定时器的当前值
+ * @param  which            ITIMER_REAL、ITIMER_VIRTUAL 或 ITIMER_PROF
+ * @param  value            返回的值(内核空间)
+ * @return int              0，which 不正确时返回 -EINVAL
+ */
+static int _getitimer(int which, struct itimerval * value)
+{
+	unsigned long val, interval;
+
+	switch (which) {
+		case ITIMER_REAL:
+			val = current->alarm ? current->alarm - jiffies : 0;
+			// 已到期但定时器还没来得及处理时，至少返回一个滴答
+			if ((long) val <= 0 && current->alarm)
+				val = 1;
+			interval = current->it_real_incr;
+			break;
+		case ITIMER_VIRTUAL:
+			val = current->it_virt_value;
+			interval = current->it_virt_incr;
+			break;
+		case ITIMER_PROF:
+			val = current->it_prof_value;
+			interval = current->it_prof_incr;
+			break;
+		default:
+			return -EINVAL;
+	}
+	jiffiestotv(val, &value->it_value);
+	jiffiestotv(interval, &value->it_interval);
+	return 0;
+}
+
+/**
+ * @brief  设置间隔定时器
+ * @param  which            ITIMER_REAL、ITIMER_VIRTUAL 或 ITIMER_PROF
+ * @param  value            新的值(内核空间)，it_value 为 0 表示停止
+ * @param  ovalue           不为空时返回原来的值(内核空间)
+ * @return int              0，which 不正确时返回 -EINVAL
+ */
+static int _setitimer(int which, struct itimerval * value,
+	struct itimerval * ovalue)
+{
+	unsigned long i, j;
+	int k;
+
+	i = tvtojiffies(&value->it_interval);
+	j = tvtojiffies(&value->it_value);
+	if (ovalue && (k = _getitimer(which, ovalue)) < 0)
+		return k;
+	switch (which) {
+		case ITIMER_REAL:
+			current->it_real_incr = i;
+			set_alarm(j ? jiffies + j : 0);
+			break;
+		case ITIMER_VIRTUAL:
+			current->it_virt_value = j;
+			current->it_virt_incr = i;
+			break;
+		case ITIMER_PROF:
+			current->it_prof_value = j;
+			current->it_prof_incr = i;
+			break;
+		default:
+			return -EINVAL;
+	}
+	return 0;
+}
+
+/**
+ * @brief  从用户空间读入 itimerval
+ */
+static void get_itimerval(struct itimerval * to, struct itimerval * from)
+{
+	int i;
+
+	for (i = 0 ; i < sizeof(*to) ; i += 4)
+		*(unsigned long *) (i + (char *) to) =
+			get_fs_long((unsigned long *) (i + (char *) from));
+}
+
+/**
+ * @brief  把 itimerval 写到用户空间
+ */
+static void put_itimerval(struct itimerval * from, struct itimerval * to)
+{
+	int i;
+
+	verify_area(to, sizeof(*to));
+	for (i = 0 ; i < sizeof(*to) ; i += 4)
+		put_fs_long(*(unsigned long *) (i + (char *) from),
+			(unsigned long *) (i + (char *) to));
+}
+
+/**
+ * @brief  getitimer 系统调用
+ * @param  which            定时器种类
+ * @param  value            用户空间返回地址
+ * @return int              0，出错返回负的错误码
+ */
+int sys_getitimer(int which, struct itimerval * value)
+{
+	struct itimerval get_buffer;
+	int k;
+
+	if (!value)
+		return -EFAULT;
+	if ((k = _getitimer(which, &get_buffer)) < 0)
+		return k;
+	put_itimerval(&get_buffer, value);
+	return 0;
+}
+
+/**
+ * @brief  setitimer 系统调用
+ * @param  which            定时器种类
+ * @param  value            用户空间的新值
+ * @param  ovalue           不为空时在这里返回原来的值
+ * @return int              0，出错返回负的错误码
+ */
+int sys_setitimer(int which, struct itimerval * value,
+	struct itimerval * ovalue)
+{
+	struct itimerval set_buffer, get_buffer;
+	int k;
+
+	if (!value)
+		return -EFAULT;
+	get_itimerval(&set_buffer, value);
+	if ((k = _setitimer(which, &set_buffer, ovalue ? &get_buffer : NULL)) < 0)
+		return k;
+	if (ovalue)
+		put_itimerval(&get_buffer, ovalue);
+	return 0;
+}
+
+/**
+ * @brief  系统调用功能-- 设置报警定时时间值(秒)
+ * 即没有间隔的 ITIMER_REAL
+ * @param  seconds          定时报警参数，大于0时，设置该新的定时值并返回原定时值。否则返回0
+ * @return int 原来的原始设置值
+ */
+int sys_alarm(long seconds)
+{
+	struct itimerval it_new, it_old;
+
+	it_new.it_interval.tv_sec = it_new.it_interval.tv_usec = 0;
+	it_new.it_value.tv_sec = (seconds > 0) ? seconds : 0;
+	it_new.it_value.tv_usec = 0;
+	_setitimer(ITIMER_REAL, &it_new, &it_old);
+	return it_old.it_value.tv_sec + (it_old.it_value.tv_usec >= 500000);
+}
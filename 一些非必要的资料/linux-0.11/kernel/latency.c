@@ -0,0 +1,149 @@
+/*
+ *  linux/kernel/latency.c
+ */
+
+/*
+ * 延迟测量(在 include/linux/config.h 中定义 LATENCY_TIMING 时编译进来)。
+ *
+ * 关中断时间：<asm/system.h> 中的 cli() 在真正关中断时调用 irqsoff_start() 记下 TSC
+ * 和所在的文件、行号，开中断的 sti()/restore_flags() 调用 irqsoff_end()。每个 cli()
+ * 位置只保留最长的一次，共保留最长的 NR_WORST 个位置。中断处理程序本身(中断门自动
+ * 关中断)和汇编代码中的 cli/sti 不在其中。
+ *
+ * 唤醒延迟：wake_up_process() 记下唤醒时的 TSC，switch_to() 切换到该任务时调用
+ * wakeup_latency() 计入按 2 的幂分档的直方图。
+ *
+ * 结果在按功能键显示任务状态时打印(show_stat())，打印后清零。
+ */
+
+#include <linux/sched.h>
+#include <linux/kernel.h>
+#include <linux/hrtimer.h>
+#include <asm/system.h>
+
+#ifdef LATENCY_TIMING
+
+#define NR_WORST	8
+
+/**
+ * @brief 一个 cli() 位置的最长关中断时间
+ */
+struct irqsoff_site {
+	const char * file;
+	int line;
+	unsigned long max_ns;
+};
+
+static struct irqsoff_site worst[NR_WORST];
+static unsigned long long irq_start = 0;	//< 关中断时的 TSC 值，0 表示没有在测量
+static const char * irq_file;
+static int irq_line;
+
+static unsigned long wake_hist[32];	//< wake_hist[i]：延迟在 2^i 到 2^(i+1)-1 纳秒之间的次数
+static unsigned long wake_max = 0;
+static int wake_max_pid = 0;
+
+/**
+ * @brief  开始一段关中断的时间，由 cli() 在中断原来是开着的时候调用(已经关中断)
+ * @param  file             cli() 所在的文件
+ * @param  line             cli() 所在的行
+ */
+void irqsoff_start(const char * file, int line)
+{
+	if (!tsc_khz)
+		return;
+	rdtsc(irq_start);
+	irq_file = file;
+	irq_line = line;
+}
+
+/**
+ * @brief  结束一段关中断的时间，由 sti()/restore_flags() 在开中断之前调用
+ * 该位置已经在表中时更新它的最长时间，否则替换表中最短的一项
+ */
+void irqsoff_end(void)
+{
+	struct irqsoff_site * w, * min;
+	unsigned long long t;
+	unsigned long ns;
+
+	if (!irq_start)
+		return;
+	rdtsc(t);
+	ns = cycles_to_ns(t - irq_start);
+	irq_start = 0;
+	min = worst;
+	for (w = worst ; w < worst + NR_WORST ; w++) {
+		if (w->file == irq_file && w->line == irq_line) {
+			if (ns > w->max_ns)
+				w->max_ns = ns;
+			return;
+		}
+		if (w->max_ns < min->max_ns)
+			min = w;
+	}
+	if (ns > min->max_ns) {
+		min->file = irq_file;
+		min->line = irq_line;
+		min->max_ns = ns;
+	}
+}
+
+/**
+ * @brief  任务 p 被唤醒后第一次运行，由 switch_to() 在关中断的情况下调用
+ * @param  p                将要运行的任务
+ */
+void wakeup_latency(struct task_struct * p)
+{
+	unsigned long long t;
+	unsigned long ns;
+	int i = 0;
+
+	if (!p->wake_tsc)
+		return;
+	rdtsc(t);
+	ns = cycles_to_ns(t - p->wake_tsc);
+	p->wake_tsc = 0;
+	if (ns)
+		__asm__("bsrl %1,%0":"=r" (i):"r" (ns));
+	wake_hist[i]++;
+	if (ns > wake_max) {
+		wake_max = ns;
+		wake_max_pid = p->pid;
+	}
+}
+
+/**
+ * @brief  打印最长的关中断时间和唤醒延迟直方图，然后清零，由 show_stat() 调用
+ */
+void latency_show(void)
+{
+	struct irqsoff_site * w, * max;
+	int i;
+
+	if (!tsc_khz) {
+		printk("latency: no TSC\n\r");
+		return;
+	}
+	printk("longest irqs-off sections (us):\n\r");
+	for (;;) {
+		max = NULL;
+		for (w = worst ; w < worst + NR_WORST ; w++)
+			if (w->max_ns && (!max || w->max_ns > max->max_ns))
+				max = w;
+		if (!max)
+			break;
+		printk("%8u  %s:%d\n\r", max->max_ns / 1000, max->file, max->line);
+		max->max_ns = 0;
+	}
+	printk("wakeup to run latency (max %u us, pid %d):\n\r",
+		wake_max / 1000, wake_max_pid);
+	for (i = 0 ; i < 32 ; i++)
+		if (wake_hist[i]) {
+			printk("  >= %u ns: %d\n\r", 1UL << i, wake_hist[i]);
+			wake_hist[i] = 0;
+		}
+	wake_max = 0;
+}
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ *  linux/kernel/prof.c
+ */
+
+/*
+ * 采样剖析(profiling)。do_timer() 每个滴答把被中断的代码地址交给 profile_tick()：
+ * 用户态的地址记入当前进程自己的计数缓冲区(在它的用户空间中，由 prof(PROF_USER)
+ * 设置)，内核态的地址记入内核的计数缓冲区 prof_kbuf(由超级用户打开，用
+ * prof(PROF_KREAD) 读出，再在主机上用 tools/kprof 对照 System.map 统计)。
+ * 地址到计数器的换算见 <sys/prof.h>。
+ */
+
+#include <errno.h>
+#include <sys/prof.h>
+
+#include <linux/sched.h>
+#include <linux/kernel.h>
+#include <asm/segment.h>
+#include <asm/system.h>
+
+static unsigned long prof_kbuf[PROF_KSLOTS];
+static unsigned long prof_koff = 0, prof_kscale = 0;	//< prof_kscale 为 0 时不采样
+
+/**
+ * @brief  地址换算成计数器下标
+ * @return unsigned long    下标，地址低于 off 或者太大时返回 ~0
+ */
+static inline unsigned long prof_index(unsigned long pc,
+	unsigned long off, unsigned long scale)
+{
+	unsigned long long i;
+
+	if (pc < off)
+		return ~0UL;
+	i = ((unsigned long long) (pc - off) * scale) >> 17;
+	return (i > 0xffffffffULL) ? ~0UL : (unsigned long) i;
+}
+
+/**
+ * @brief  记录一次采样，由 do_timer() 在关中断时调用
+ * 用户态的计数器在进程的用户空间中，这里不能访问(可能缺页或写保护)，只把采样记在
+ * current->prof_ticks/prof_pc 中，返回用户态时由 prof_flush() 写入。在那之前用户
+ * 代码没有运行，地址不会变，所以一对 prof_pc/prof_ticks 就够了
+ * @param  cpl              被中断代码的特权级，0 - 内核态
+ * @param  eip              被中断代码的地址
+ * @param  ticks            这次采样代表的滴答数(空闲时一个周期可能有几个滴答)
+ */
+void profile_tick(long cpl, unsigned long eip, unsigned long ticks)
+{
+	unsigned long i;
+
+	if (!cpl) {
+		if (prof_kscale &&
+		    (i = prof_index(eip, prof_koff, prof_kscale)) < PROF_KSLOTS)
+			prof_kbuf[i] += ticks;
+		return;
+	}
+	if (!current->prof_scale)
+		return;
+	current->prof_pc = eip;
+	current->prof_ticks += ticks;
+}
+
+/**
+ * @brief  把记下的用户态采样写入计数缓冲区
+ * 由 kernel/system_call.s 中的 ret_from_sys_call 在返回用户态之前调用，和处理信号
+ * 一样是在进程上下文中，写之前用 verify_area() 处理写时复制，缺页时可以睡眠
+ */
+void prof_flush(void)
+{
+	unsigned long i, ticks = current->prof_ticks;
+	short * p;
+
+	current->prof_ticks = 0;
+	sti();
+	if (!current->prof_scale)
+		return;
+	i = prof_index(current->prof_pc, current->prof_off, current->prof_scale);
+	if (i >= current->prof_size / 2)
+		return;
+	p = i + (short *) current->prof_base;
+	verify_area(p, 2);
+	put_fs_word(get_fs_word((unsigned short *) p) + ticks, p);
+}
+
+/**
+ * @brief  prof 系统调用：打开、关闭剖析或读出内核的计数
+ * @param  which            PROF_USER、PROF_KERNEL 或 PROF_KREAD，见 <sys/prof.h>
+ * @param  pr               用户空间的参数，PROF_USER 时为空表示关闭
+ * @return int              0(PROF_KREAD 返回复制的字节数)，出错返回负的错误码
+ */
+int sys_prof(int which, struct prof * pr)
+{
+	struct prof p;
+	unsigned long flags, n;
+	int i;
+
+	if (pr)
+		for (i = 0 ; i < sizeof(p) ; i += 4)
+			*(unsigned long *) (i + (char *) &p) =
+				get_fs_long((unsigned long *) (i + (char *) pr));
+	switch (which) {
+		case PROF_USER:
+			if (!pr || !p.pr_scale) {
+				current->prof_scale = 0;
+				return 0;
+			}
+			current->prof_base = (unsigned long) p.pr_base;
+			current->prof_size = p.pr_size;
+			current->prof_off = p.pr_off;
+			current->prof_scale = p.pr_scale;
+			return 0;
+		case PROF_KERNEL:
+			if (!suser())
+				return -EPERM;
+			save_flags(flags);
+			cli();
+			prof_kscale = 0;
+			for (n = 0 ; n < PROF_KSLOTS ; n++)
+				prof_kbuf[n] = 0;
+			if (pr) {
+				prof_koff = p.pr_off;
+				prof_kscale = p.pr_scale;
+			}
+			restore_flags(flags);
+			return 0;
+		case PROF_KREAD:
+			if (!pr)
+				return -EFAULT;
+			n = p.pr_size & ~3;
+			if (n > sizeof(prof_kbuf))
+				n = sizeof(prof_kbuf);
+			verify_area(p.pr_base, n);
+			for (i = 0 ; i < n / 4 ; i++)
+				put_fs_long(prof_kbuf[i], i + (unsigned long *) p.pr_base);
+			verify_area(pr, sizeof(*pr));
+			put_fs_long(prof_koff, &pr->pr_off);
+			put_fs_long(prof_kscale, &pr->pr_scale);
+			return n;
+	}
+	return -EINVAL;
+}
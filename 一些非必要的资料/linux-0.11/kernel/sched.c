@@ -15,9 +15,12 @@
 #include <linux/kernel.h>
 #include <linux/sys.h>
 #include <linux/fdreg.h>
+#include <linux/hrtimer.h>
+#include <linux/trace.h>
 #include <asm/system.h>
 #include <asm/io.h>
 #include <asm/segment.h>
+#include <asm/div64.h>
 
 #include <signal.h>
 
@@ -49,6 +52,11 @@ void show_task(int nr, struct task_struct *p)
         i++;
     printk("%d (of %d) chars free in kernel stack\n\r", i, j);
 }
+extern void hd_show_stat(void);
+#ifdef LATENCY_TIMING
+extern void wakeup_latency(struct task_struct *p);  // kernel/latency.c
+extern void latency_show(void);
+#endif
 /**
  * @brief 显示所有任务的任务号、进程号、进程状态
  * 和内核堆栈空闲字节数
@@ -60,6 +68,11 @@ void show_stat(void)
     for (i = 0; i < NR_TASKS; i++)
         if (task[i])
             show_task(i, task[i]);
+    hd_show_stat();
+#ifdef LATENCY_TIMING
+    latency_show();
+#endif
+    trace_dump();
 }
 //< 定义每个时间片的滴答数
 #define LATCH (1193180 / HZ)
@@ -70,11 +83,18 @@ extern void mem_use(void);
  * @return int 中断处理结果
  */
 extern int timer_interrupt(void);
+extern void profile_tick(long cpl, unsigned long eip, unsigned long ticks); // kernel/prof.c
 /**
  * @brief 系统调用中断处理程序
  * @return int 中断处理结果
  */
 extern int system_call(void);
+extern int sysenter_entry(void);   // sysenter 的入口(kernel/system_call.s)
+extern int __sysenter_probe(void); // lib/sysenter.c
+
+#define MSR_SYSENTER_CS  0x174
+#define MSR_SYSENTER_ESP 0x175
+#define MSR_SYSENTER_EIP 0x176
 /**
  * @brief 任务联合结构体(任务成员和stack)
  * 因为一个任务的数据结构与其内核态堆栈放在同一内存页
@@ -164,6 +184,114 @@ void math_state_restore()
     }
 }
 
+extern void switch_stacks(long *save_esp, long new_esp);
+
+static unsigned long long acct_tsc = 0;  //< 上次统计 CPU 时间时的 TSC 值
+
+/**
+ * @brief  把上次统计以来的时间计入当前任务的用户态或内核态时间(需要 TSC)，调用者负责关中断
+ * 纳秒数累计在 utime_ns/stime_ns 中，utime/stime 由它们换算成滴答数，这样只运行了
+ * 一个滴答中一小段时间的任务也能统计准确
+ * @param  user             1 - 计入用户态时间，0 - 计入内核态时间
+ */
+static void account_cpu(int user)
+{
+    unsigned long long t, ns;
+
+    rdtsc(t);
+    ns = cycles_to_ns(t - acct_tsc);
+    acct_tsc = t;
+    if (user)
+    {
+        ns = current->utime_ns += ns;
+        do_div(ns, NSEC_PER_JIFFY);
+        current->utime = (long)ns;
+    }
+    else
+    {
+        ns = current->stime_ns += ns;
+        do_div(ns, NSEC_PER_JIFFY);
+        current->stime = (long)ns;
+    }
+}
+
+/**
+ * @brief  系统调用进入内核时调用(kernel/system_call.s)，此前的时间是用户态时间(需要 TSC)
+ */
+void account_entry(void)
+{
+    unsigned long flags;
+
+    save_flags(flags);
+    cli();
+    account_cpu(1);
+    restore_flags(flags);
+}
+
+/**
+ * @brief  返回用户态前调用(kernel/system_call.s)，此前的时间是内核态时间(需要 TSC)
+ */
+void account_exit(void)
+{
+    unsigned long flags;
+
+    save_flags(flags);
+    cli();
+    account_cpu(0);
+    restore_flags(flags);
+}
+
+/**
+ * @brief  切换到任务 n
+ * 只改唯一的 TSS(任务 0 的)中的 esp0 和 LDTR，然后交换内核栈。硬件任务切换每次都会
+ * 置 TS 标志，这里也同样处理：除非新任务就是协处理器状态的所有者(last_task_used_math)，
+ * 否则置 TS，第一次使用协处理器时由 math_state_restore() 换入它的状态。
+ * @param  n                任务号
+ */
+void switch_to(int n)
+{
+    struct task_struct *prev = current, *next = task[n];
+    unsigned long flags;
+
+    if (next == prev)
+        return;
+    save_flags(flags);
+    cli();
+    // 切换任务总是在内核态。进入内核(系统调用或时钟中断)时已经把之前的用户态时间
+    // 记上了，所以从那以后到现在的时间算作 prev 的内核态时间
+    if (tsc_khz)
+        account_cpu(0);
+    trace(TRACE_SWITCH, prev->pid, next->pid);
+#ifdef LATENCY_TIMING
+    wakeup_latency(next);
+#endif
+    init_task.task.tss.esp0 = PAGE_SIZE + (long)next;
+    lldt(n);
+    if (next == last_task_used_math)
+        __asm__("clts");
+    else
+        __asm__("movl %%cr0,%%eax\n\t"
+                "orl $8,%%eax\n\t"
+                "movl %%eax,%%cr0" ::: "ax");
+    current = next;
+    switch_stacks(&prev->ksp, next->ksp);
+    // 重新切换回来时已经在本任务的栈上，恢复本任务切换出去时的中断标志
+    restore_flags(flags);
+}
+
+/**
+ * @brief  睡眠超时到期：清 timeout 并唤醒可中断睡眠的任务，由调用者自己检查超时
+ * @param  data             任务结构指针
+ */
+static void process_timeout(unsigned long data)
+{
+    struct task_struct *p = (struct task_struct *)data;
+
+    p->timeout = 0;
+    if (p->state == TASK_INTERRUPTIBLE)
+        wake_up_process(p);
+}
+
 /*
  *  'schedule()' is the scheduler function. This is GOOD CODE! There
  * probably won't be any reason to change this, as it should work well
@@ -178,31 +306,39 @@ void schedule(void)
 {
     int i, next, c;
     struct task_struct **p; // 当前的任务结构体指针
+    struct timer_list timer; // 当前任务的睡眠超时定时器
+    int timeout = 0;
 
-    /* check alarm, wake up any interruptible tasks that have got a signal */
+    // select()/poll() 设置了超时的可中断睡眠：用定时器在到期时唤醒
+    if (current->timeout && current->state == TASK_INTERRUPTIBLE)
+    {
+        if ((long)(current->timeout - jiffies) <= 0)
+        {
+            current->timeout = 0;
+            current->state = TASK_RUNNING;
+        }
+        else
+        {
+            init_timer(&timer, process_timeout, (unsigned long)current);
+            mod_timer(&timer, current->timeout);
+            timeout = 1;
+        }
+    }
+
+    /* wake up any interruptible tasks that have got a signal */
     // 从后向前遍历，找出任何得到信号的可中断任务,进行唤醒调度
+    // alarm 和 timeout 不再在这里检查，由定时器(kernel/itimer.c、process_timeout())处理
     for (p = &LAST_TASK; p > &FIRST_TASK; --p)
     {
         if (*p)
         {
-            // 果设置过任务的定时值 alarm，并且已经过期(alarm<jiffies),则在信号位图中置 SIGALRM 信号，
-            // 向任务发送 SIGALARM 信号。然后清alarm。该信号的默认操作是终止进程。
-            // jiffies 是系统从开机开始算起的滴答数（10ms/滴答）。定义在 sched.h 第 139 行。
-            if ((*p)->alarm && (*p)->alarm < jiffies)
-            {
-
-                // 设置信号位为 SIGALRM
-                (*p)->signal |= (1 << (SIGALRM - 1));
-                // 设置调度时钟为 0
-                (*p)->alarm = 0;
-            }
             // 如果信号位图中除被阻塞的信号外还有其它信号，并且任务处于可中断状态，则置任务为就绪状态。
             // 其中'~(_BLOCKABLE & (*p)->blocked)'用于忽略被阻塞的信号，但 SIGKILL 和 SIGSTOP 不能被阻塞。
             if (((*p)->signal & ~(_BLOCKABLE & (*p)->blocked)) &&
                 (*p)->state == TASK_INTERRUPTIBLE)
             {
                 // 恢复任务运行
-                (*p)->state = TASK_RUNNING;
+                wake_up_process(*p);
             }
         }
     }
@@ -254,7 +390,124 @@ void schedule(void)
     }
     // 切换到next的任务运行
     switch_to(next);
+    // 重新运行时取消还没到期的超时定时器(它在本任务的内核栈上)
+    if (timeout)
+        del_timer(&timer);
 }
+
+/*
+ * 空闲时减少时钟中断。8253 计数器 0 工作在方式 2，写入的新计数值不影响正在进行的计数，
+ * 要到当前周期结束时才装入，因此计时不会有误差。tick_cur 是当前周期的滴答数，
+ * tick_next 是下一个周期的滴答数(最后写入的值)。计数值最大 65535，一个周期最长
+ * TICK_MAX 个滴答。
+ */
+#define TICK_MAX (0xffff / LATCH)
+
+static unsigned long tick_cur = 1, tick_next = 1;
+static volatile int in_idle = 0;  //< 任务 0 正在 cpu_idle() 中停机
+static unsigned long long tick_tsc = 0;  //< 当前周期开始(处理时钟中断)时的 TSC 值
+static unsigned long long last_hr = 0;   //< hr_now() 上次返回的值
+
+/**
+ * @brief  设置下一个周期的长度，调用者负责关中断
+ * @param  n                滴答数(1 - TICK_MAX)
+ */
+static void set_tick(unsigned long n)
+{
+    if (n == tick_next)
+        return;
+    tick_next = n;
+    outb_p((n * LATCH) & 0xff, 0x40);
+    outb((n * LATCH) >> 8, 0x40);
+}
+
+/**
+ * @brief  下一个时钟中断时 jiffies 的值，调用者负责关中断
+ */
+unsigned long next_tick_jiffies(void)
+{
+    return jiffies + tick_cur;
+}
+
+/**
+ * @brief  开机以来的纳秒数
+ * 由 jiffies 和周期内已经过去的时间得出：当前周期开始时 jiffies 已经计入，周期内的
+ * 时间有 TSC 时由它算出，否则读 8253 计数器 0 的当前值
+ * @return unsigned long long 纳秒数
+ */
+unsigned long long hr_now(void)
+{
+    unsigned long flags, count, j, elapsed;
+    unsigned long long ns;
+
+    save_flags(flags);
+    cli();
+    if (tsc_khz)
+    {
+        rdtsc(ns);
+        ns = (unsigned long long)jiffies * NSEC_PER_JIFFY + cycles_to_ns(ns - tick_tsc);
+        // tick_tsc 是处理时钟中断时才记下的，比周期真正开始晚一点，刚进入新周期时
+        // 算出的值可能比上次的小，这时返回上次的值，保证时间不倒退
+        if (ns < last_hr)
+            ns = last_hr;
+        last_hr = ns;
+        restore_flags(flags);
+        return ns;
+    }
+    outb_p(0x00, 0x43);     /* latch count of ch 0 */
+    count = inb_p(0x40);
+    count |= inb_p(0x40) << 8;
+    j = jiffies;
+    elapsed = tick_cur * LATCH - count;
+    // 计数器已经重新装入但时钟中断还没处理(8259A 的 IRR 位 0 置位)：当前周期已经结束。
+    // 锁存之后才装入的，这时读到的计数值还很小，不算
+    outb_p(0x0a, 0x20);
+    if ((inb_p(0x20) & 1) && count > tick_next * LATCH / 2)
+    {
+        j += tick_cur;
+        elapsed = tick_next * LATCH - count;
+    }
+    restore_flags(flags);
+    ns = (unsigned long long)elapsed * NSEC_PER_JIFFY;
+    do_div(ns, LATCH);
+    return (unsigned long long)j * NSEC_PER_JIFFY + ns;
+}
+
+/**
+ * @brief  是否有任务 0 以外的任务可以运行
+ */
+static int runnable(void)
+{
+    int i;
+
+    for (i = 1; i < NR_TASKS; i++)
+        if (task[i] && task[i]->state == TASK_RUNNING)
+            return 1;
+    return 0;
+}
+
+/**
+ * @brief  任务 0 的空闲处理：没有其它任务可运行时停机(hlt)等待中断
+ * 停机期间由 do_timer() 把时钟周期加长到下一个定时器到期为止
+ */
+static void cpu_idle(void)
+{
+    cli();
+    if (!runnable())
+    {
+        in_idle = 1;
+        // sti 之后的一条指令执行完才响应中断，所以不会错过在这之间的唤醒
+        irqsoff_end();
+        __asm__("sti ; hlt");
+        cli();
+        in_idle = 0;
+        // 有任务被唤醒时，当前的周期结束后恢复正常的时钟周期，以便分配时间片
+        if (runnable())
+            set_tick(1);
+    }
+    sti();
+}
+
 // 将当前任务设置为可中断的等待状态
 // 放入*p 指定的等待队列中
 // 暂停系统调用，主要用于main主线程进行
@@ -267,87 +520,158 @@ int sys_pause(void)
 {
     current->state = TASK_INTERRUPTIBLE;
     schedule();
+    // 任务 0 回到这里说明没有其它任务可以运行
+    if (current == task[0])
+        cpu_idle();
     return 0;
 }
 /**
- * @brief  睡眠函数
- * @param  p   防止等待任务的队列头指针
+ * @brief  把等待项 wait 加到队列 *p 的尾部
+ * 队列也会在中断中被遍历(wake_up)，因此修改期间关中断
+ * @param  p                等待队列头指针
+ * @param  wait             等待项，一般位于调用者的内核栈上
  */
-void sleep_on(struct task_struct **p)
+void add_wait_queue(struct wait_queue **p, struct wait_queue *wait)
 {
-    struct task_struct *tmp;
+    unsigned long flags;
+
+    save_flags(flags);
+    cli();
+    wait->next = NULL;
+    while (*p)
+        p = &(*p)->next;
+    *p = wait;
+    restore_flags(flags);
+}
+/**
+ * @brief  把等待项 wait 从队列 *p 中摘除
+ * @param  p                等待队列头指针
+ * @param  wait             要摘除的等待项
+ */
+void remove_wait_queue(struct wait_queue **p, struct wait_queue *wait)
+{
+    unsigned long flags;
+
+    save_flags(flags);
+    cli();
+    for (; *p; p = &(*p)->next)
+        if (*p == wait)
+        {
+            *p = wait->next;
+            break;
+        }
+    restore_flags(flags);
+}
+/**
+ * @brief  把当前任务以状态 state 挂到队列 *p 上睡眠，被唤醒后摘除
+ * 等待项放在本函数的栈帧里，睡眠期间一直有效
+ * @param  p                等待队列头指针
+ * @param  state            TASK_UNINTERRUPTIBLE 或 TASK_INTERRUPTIBLE
+ * @param  flags            等待项标志(WQ_FLAG_EXCLUSIVE)
+ */
+static inline void __sleep_on(struct wait_queue **p, int state, int flags)
+{
+    struct wait_queue wait;
 
     if (!p)
         return;
     // 0 号进程不允许睡眠
     if (current == &(init_task.task))
         panic("task[0] trying to sleep");
-    // 保存原始队头指针
-    tmp = *p;
-    // 头部重新指向当前进程
-    *p = current;
-    // 设置为不可中断
-    current->state = TASK_UNINTERRUPTIBLE;
-    // 再次进行调度
+    wait.task = current;
+    wait.flags = flags;
+    // 先设置状态再入队：入队后到 schedule() 之前的唤醒只会把状态改回运行，不会丢失
+    current->state = state;
+    add_wait_queue(p, &wait);
     schedule();
-    // 将其他任务设置为0--运行状态(就绪准备运行)
-    if (tmp)
-        tmp->state = 0;
+    remove_wait_queue(p, &wait);
+}
+/**
+ * @brief  睡眠函数，不可被信号打断
+ * @param  p   等待队列头指针
+ */
+void sleep_on(struct wait_queue **p)
+{
+    __sleep_on(p, TASK_UNINTERRUPTIBLE, 0);
+}
+/**
+ * @brief  独占方式睡眠，不可被信号打断
+ * 一次 wake_up() 只唤醒一个独占等待者，用于等待空闲请求项、空闲缓冲块等
+ * 每次释放只够一个进程使用的资源，避免所有等待者一起醒来再重新检查
+ * @param  p   等待队列头指针
+ */
+void sleep_on_exclusive(struct wait_queue **p)
+{
+    __sleep_on(p, TASK_UNINTERRUPTIBLE, WQ_FLAG_EXCLUSIVE);
 }
 /**
  * @brief  将当前任务设置为可中断的状态，并放入*p 指定的等待队列中
- * 主要用来进行将当前正在执行的任务切出，并重新进行调度
- * @param  p  任务队列头部指针
+ * 收到信号时 schedule() 会把任务置为就绪，调用者需要自己检查条件和信号
+ * @param  p  等待队列头指针
  */
-void interruptible_sleep_on(struct task_struct **p)
+void interruptible_sleep_on(struct wait_queue **p)
 {
-    struct task_struct *tmp;
+    __sleep_on(p, TASK_INTERRUPTIBLE, 0);
+}
+/**
+ * @brief  把睡眠的任务置为就绪状态，可以在中断中调用
+ * 所有唤醒都经过这里，以便跟踪(TRACE_WAKEUP)和测量唤醒到运行的延迟
+ * @param  p                任务结构指针
+ */
+void wake_up_process(struct task_struct *p)
+{
+    p->state = TASK_RUNNING;
+    trace(TRACE_WAKEUP, p->pid, 0);
+#ifdef LATENCY_TIMING
+    if (tsc_khz && !p->wake_tsc)
+        rdtsc(p->wake_tsc);
+#endif
+}
 
-    if (!p)
+/**
+ * @brief  唤醒队列 *q 上的进程
+ * 等待项只由睡眠者自己摘除，这里只修改进程状态，可以在中断中调用
+ * @param  q                等待队列头指针
+ * @param  all              为 0 时只唤醒一个仍在睡眠的独占等待者
+ */
+static inline void __wake_up(struct wait_queue **q, int all)
+{
+    struct wait_queue *tmp;
+    struct task_struct *p;
+
+    if (!q)
         return;
-    if (current == &(init_task.task))
-        panic("task[0] trying to sleep");
-    // 保存原有头部指针
-    tmp = *p;
-    // 头部指向当前指针
-    *p = current;
-// 重复操作
-repeat:
-    // 设置状态为可中断
-    // 方便进行切换
-    current->state = TASK_INTERRUPTIBLE;
-    // 重新进行调度
-    schedule();
-    /**
-     * 队列头部不为当前运行任务--等待队列中存在其他等待任务
-     * 当指针*p 所指向的不是当前任务时，表示在当前任务被放
-     * 入队列后，又有新的任务被插入等待队列中，因此就应该将其他
-     * 的等待任务设置为可运行状态
-     */
-    if (*p && *p != current)
+    for (tmp = *q; tmp; tmp = tmp->next)
     {
-        (**p).state = 0;
-        goto repeat;
+        if (!(p = tmp->task))
+            continue;
+        // 已经被唤醒但尚未运行的独占等待者不算数，继续找下一个
+        if ((tmp->flags & WQ_FLAG_EXCLUSIVE) && !all &&
+            (p->state == TASK_UNINTERRUPTIBLE || p->state == TASK_INTERRUPTIBLE))
+        {
+            wake_up_process(p);
+            break;
+        }
+        if (p->state == TASK_UNINTERRUPTIBLE || p->state == TASK_INTERRUPTIBLE)
+            wake_up_process(p); // 设置为就绪(可运行)状态
     }
-    // 此时所有任务均为已经调度的状态
-    // 重新设置当前任务
-    *p = NULL;
-    // 如果头部任务任务仍旧存在
-    // 将其设置为就绪状态
-    if (tmp)
-        tmp->state = 0;
 }
 /**
- * @brief  唤醒指定任务*p
- * @param  p                指定任务指针
+ * @brief  唤醒队列中所有非独占等待者和一个独占等待者
+ * @param  q                等待队列头指针
  */
-void wake_up(struct task_struct **p)
+void wake_up(struct wait_queue **q)
 {
-    if (p && *p)
-    {
-        (**p).state = 0; // 设置为就绪(可运行)状态
-        *p = NULL;
-    }
+    __wake_up(q, 0);
+}
+/**
+ * @brief  唤醒队列中的所有等待者(包括全部独占等待者)
+ * 用于释放锁、对象失效等所有等待者都必须重新检查的场合
+ * @param  q                等待队列头指针
+ */
+void wake_up_all(struct wait_queue **q)
+{
+    __wake_up(q, 1);
 }
 
 /*
@@ -361,29 +685,52 @@ void wake_up(struct task_struct **p)
  * 软盘驱动程序（floppy.c）后面的说明。或者到阅读软盘块设备驱动程序时在来看这段代码。
  * 其中时间单位：1个滴答 = 1/100 秒
  * */
-//下面数组存放等待软驱马达启动到正常转速的进程指针。数组索引 0 - 3 分别对应软驱 A - D。 static struct task_struct *wait_motor[4] = {NULL, NULL, NULL, NULL};
-static struct task_struct *wait_motor[4] = {NULL, NULL, NULL, NULL};
+//下面数组存放等待软驱马达启动到正常转速的进程队列。数组索引 0 - 3 分别对应软驱 A - D。 static struct wait_queue *wait_motor[4] = {NULL, NULL, NULL, NULL};
+static struct wait_queue *wait_motor[4] = {NULL, NULL, NULL, NULL};
 /**
- * @brief 软驱马达需要的滴答数
- * 程序中默认启动时间为50 个滴答(0.5秒)
+ * @brief 软驱马达的定时器：mon_timer 在马达达到正常转速时唤醒等待的进程，
+ * moff_timer 在软驱停止使用一段时间后关闭马达
  */
-static int mon_timer[4] = {0, 0, 0, 0};
-static int moff_timer[4] = {0, 0, 0, 0};
+static struct hrtimer mon_timer[4];
+static struct hrtimer moff_timer[4];
 unsigned char current_DOR = 0x0C;
+
 /**
- * @brief  指定驱动启动到正常运转状态需要等待时间
- * @param  nr               软件驱动号(0-3),返回值为滴答数
- * @return int 处理结果
+ * @brief  马达已达到正常转速：唤醒等待的进程
+ * @param  nr               软驱号(0-3)
  */
-int ticks_to_floppy_on(unsigned int nr)
+static void motor_on_callback(unsigned long nr)
+{
+    wake_up(nr + wait_motor);
+}
+
+/**
+ * @brief  软驱停止使用已有 3 秒：关闭马达
+ * @param  nr               软驱号(0-3)
+ */
+static void motor_off_callback(unsigned long nr)
+{
+    current_DOR &= ~(0x10 << nr);
+    outb(current_DOR, FD_DOR);
+}
+
+/**
+ * @brief  启动软驱马达并选中软驱，求它可以使用的时间
+ * @param  nr               软驱号(0-3)
+ * @return unsigned long long 马达达到正常转速的时间(见 hr_now())，已经可以使用时返回 0
+ */
+unsigned long long floppy_on_time(unsigned int nr)
 {
     extern unsigned char selected;
     unsigned char mask = 0x10 << nr;
+    unsigned long long t;
+    unsigned long flags;
 
     if (nr > 3)
         panic("floppy_on: nr>3");
-    moff_timer[nr] = 10000; /* 100 s = very big :-) */
+    save_flags(flags);
     cli();                  /* use floppy_off to turn it off */
+    hrtimer_cancel(moff_timer + nr);
     mask |= current_DOR;
     if (!selected)
     {
@@ -393,173 +740,122 @@ int ticks_to_floppy_on(unsigned int nr)
     if (mask != current_DOR)
     {
         outb(mask, FD_DOR);
+        // 马达刚启动要等 0.5 秒，只是换了软驱时至少等 20 毫秒
         if ((mask ^ current_DOR) & 0xf0)
-            mon_timer[nr] = HZ / 2;
-        else if (mon_timer[nr] < 2)
-            mon_timer[nr] = 2;
+            hrtimer_start(mon_timer + nr, hr_now() + MSEC_NS(500));
+        else
+        {
+            t = hr_now() + MSEC_NS(20);
+            if (!hrtimer_pending(mon_timer + nr) || mon_timer[nr].expires < t)
+                hrtimer_start(mon_timer + nr, t);
+        }
         current_DOR = mask;
     }
-    sti();
-    return mon_timer[nr];
+    if (hrtimer_pending(mon_timer + nr))
+        t = mon_timer[nr].expires;
+    else
+        t = 0;
+    restore_flags(flags);
+    return t;
 }
 /**
  * @brief 等待指定软驱动马达启动需要的一段时间，然后返回
  * 设置指定软驱动的马达启动到正常转速需要的延时，然后睡眠等待
- * 在定时中断过程中会一直递减
- * 判断这里设定的延迟值。当延时到期，就会唤醒这里的等待进程
- * @param  nr               My Param doc
+ * 马达定时器到期时会唤醒这里的等待进程
+ * @param  nr               软驱号(0-3)
  */
 void floppy_on(unsigned int nr)
 {
     cli();
     // 如果马达启动定时还没到，就一直将当前进程设置为
     // 不可中断睡眠状态，并放入等待马达运行到队列中
-    while (ticks_to_floppy_on(nr))
+    while (floppy_on_time(nr))
         sleep_on(nr + wait_motor);
     sti();
 }
 
-void floppy_off(unsigned int nr)
-{
-    moff_timer[nr] = 3 * HZ;
-}
 /**
- * @brief 软盘定时处理子程序
- * 每10ms调用一次
- * 如果某个马达停转定时达到，则将数字输出寄存器进行复位
+ * @brief  软驱不再使用，3 秒后关闭马达
+ * @param  nr               软驱号(0-3)
  */
-void do_floppy_timer(void)
+void floppy_off(unsigned int nr)
 {
-    int i;
-    unsigned char mask = 0x10;
-
-    for (i = 0; i < 4; i++, mask <<= 1)
-    {
-        if (!(mask & current_DOR))
-            continue;
-        if (mon_timer[i])
-        {
-            if (!--mon_timer[i])
-                wake_up(i + wait_motor);
-        }
-        else if (!moff_timer[i])
-        {
-            current_DOR &= ~mask;
-            outb(current_DOR, FD_DOR);
-        }
-        else
-            moff_timer[i]--;
-    }
+    hrtimer_start(moff_timer + nr, hr_now() + SEC_NS(3));
 }
 
-#define TIME_REQUESTS 64
-/**
- * @brief 定时器链表结构和定时器数组
- */
-static struct timer_list
-{
-    long jiffies;            //< 定时器滴答数
-    void (*fn)();            //< 定时器指定处理程序
-    struct timer_list *next; //< 下一个定时器指针
-} timer_list[TIME_REQUESTS], *next_timer = NULL;
-/**
- * @brief  增加定时器
- * @param  jiffies          指定时间片
- * @param  fn               对应的执行处理函数
- */
-void add_timer(long jiffies, void (*fn)(void))
-{
-    // 时间数组指针
-    struct timer_list *p;
-
-    // 空指针直接返回
-    if (!fn)
-        return;
-    // 禁止中断 https://blog.csdn.net/zang141588761/article/details/52325106
-    cli();
-    // 时间片耗尽--直接执行
-    if (jiffies <= 0)
-        (fn)();
-    else
-    {
-        // 增加到时间队列中
-        for (p = timer_list; p < timer_list + TIME_REQUESTS; p++) {
-            // 找到一个函数为空的时间队列
-            if (!p->fn) {
-                break;
-            }
-        }
-        // 没有空闲定时器--直接报错
-        if (p >= timer_list + TIME_REQUESTS)
-            panic("No more time requests free");
-        // 重新设置时间片信息
-        p->fn = fn;
-        p->jiffies = jiffies;
-        p->next = next_timer;
-        // 将下一个时间片指针指向p
-        next_timer = p;
-        // 如果当前剩余时间片小于下一个
-        // 进行调整，保证从小到大的顺序排序
-        // 检查头部指针时间片是否为0 即可
-        while (p->next && p->next->jiffies < p->jiffies)
-        {
-            p->jiffies -= p->next->jiffies;
-            fn = p->fn;
-            p->fn = p->next->fn;
-            p->next->fn = fn;
-            jiffies = p->jiffies;
-            p->jiffies = p->next->jiffies;
-            p->next->jiffies = jiffies;
-            p = p->next;
-        }
-    }
-    // 恢复中断
-    sti();
-}
 /**
  * @brief  时钟中断c 处理程序，在kernel/system_call.s 的timer_interrupt 中被调用
  * 用于进行时间中断处理,主要用来唤醒调度函数用于进行程序调度
  * 对于一个进程由于执行时间片用完，则进行任务切换。并执行一个计时器更新
  * 这里写了程序调度和磁盘数据处理
  * @param  cpl              当前特权级别0或者3,0 表示内核代码在执行
+ * @param  eip              被中断代码的地址，用于剖析
  */
-void do_timer(long cpl)
+void do_timer(long cpl, unsigned long eip)
 {
     extern int beepcount;   //< 扬声器发声时间滴答数(kernel/chr_drv/console.c,697)
     extern void sysbeepstop(void);  //< 关闭扬声器(kernel/chr_drv/console.c)
+    unsigned long ticks = tick_cur;  // 刚结束的周期有几个滴答(空闲时可能大于 1)
+    long n;
 
+    tick_cur = tick_next;
+    jiffies += ticks - 1;   // timer_interrupt 已经加了 1
+    if (tsc_khz)
+        rdtsc(tick_tsc);
     // 如果发声计数次数到，则关闭发声(向 0x61发送命令，复位位0和1，位0控制8253计数器2的工作，位1控制扬声器)
     if (beepcount)
-        if (!--beepcount)
+        if ((beepcount -= ticks) <= 0)
+        {
+            beepcount = 0;
             sysbeepstop();
+        }
+    // 有 TSC 时按实际运行的时间统计，否则整个周期都算给被中断的任务：
     // 如果特权级别非0，增加用户时间片
-    if (cpl)
-        current->utime++;
+    if (tsc_khz)
+        account_cpu(cpl != 0);
+    else if (cpl)
+        current->utime += ticks;
     else // 内核级别，增加超级用户时间片
-        current->stime++;
+        current->stime += ticks;
 
-    // 存在其它的用户定时器--需要调度
-    // 将当前定时器值--
-    // 如果jiffies < 1 执行定时器函数，并取消该定时器
-    if (next_timer)
+    // ITIMER_VIRTUAL 只在用户态计时，ITIMER_PROF 在用户态和内核态都计时。和上面的
+    // utime/stime 一样按 ticks 递减，空闲时加长的周期不会让它们走慢
+    if (cpl && current->it_virt_value)
+    {
+        if (current->it_virt_value > ticks)
+            current->it_virt_value -= ticks;
+        else
+        {
+            current->it_virt_value = current->it_virt_incr;
+            current->signal |= (1 << (SIGVTALRM - 1));
+        }
+    }
+    if (current->it_prof_value)
     {
-        next_timer->jiffies--;
-        while (next_timer && next_timer->jiffies <= 0)
+        if (current->it_prof_value > ticks)
+            current->it_prof_value -= ticks;
+        else
         {
-            // 插入函数指针定义
-            void (*fn)(void);
-            // 获取函数指针
-            fn = next_timer->fn;
-            next_timer->fn = NULL;
-            // 指向下一个
-            next_timer = next_timer->next;
-            // 继续执行
-            (fn)();
+            current->it_prof_value = current->it_prof_incr;
+            current->signal |= (1 << (SIGPROF - 1));
         }
     }
-    // 如果当前软盘控制器 FDC 的数字输出寄存器中马达启动位有置位的，则执行软盘定时程序(245 行)
-    if (current_DOR & 0xf0)
-        do_floppy_timer();
+    // 执行到期的定时器(kernel/timer.c)
+    run_timers();
+    // 执行到期的高精度定时器(kernel/hrtimer.c)，软驱马达的定时也在其中
+    run_hrtimers();
+    // 空闲时把刚开始的周期之后的那个周期加长到下一个定时器到期为止。发声是按滴答
+    // 计数的，这时不加长
+    if (in_idle && !beepcount)
+    {
+        n = next_timer_jiffies(tick_cur + TICK_MAX);
+        n = next_hrtimer_jiffies(n) - (jiffies + tick_cur);
+        set_tick(n < 1 ? 1 : (n > TICK_MAX ? TICK_MAX : n));
+    }
+    else
+        set_tick(1);
+    // 剖析采样(kernel/prof.c)
+    profile_tick(cpl, eip, ticks);
     // 发现当前时间片仍然存在
     // 之际返回
     if ((--current->counter) > 0)
@@ -572,22 +868,6 @@ void do_timer(long cpl)
     // 用户调用执行调度程序
     schedule();
 }
-/**
- * @brief  系统调用功能-- 设置报警定时时间值(秒)
- * @param  seconds          定时报警参数，大于0时，设置该新的定时值并返回原定时值。否则返回0
- * @return int 原来的原始设置值
- */
-int sys_alarm(long seconds)
-{
-    int old = current->alarm;
-
-    if (old)
-        old = (old - jiffies) / HZ;
-    // 
-    current->alarm = (seconds > 0) ? (jiffies + HZ * seconds) : 0;
-    return (old);
-}
-
 int sys_getpid(void)
 {
     return current->pid;
@@ -639,6 +919,12 @@ void sched_init(void)
     set_tss_desc(gdt + FIRST_TSS_ENTRY, &(init_task.task.tss));
     // 保存初始任务的局部数据表描述符号
     set_ldt_desc(gdt + FIRST_LDT_ENTRY, &(init_task.task.ldt));
+    init_timer(&init_task.task.real_timer, it_real_fn, (unsigned long)&init_task.task);
+    for (i = 0; i < 4; i++)
+    {
+        hrtimer_init(mon_timer + i, motor_on_callback, i);
+        hrtimer_init(moff_timer + i, motor_off_callback, i);
+    }
     // 计算当前页号
     p = gdt + 2 + FIRST_TSS_ENTRY;
     // 遍历任务缓冲区
@@ -658,10 +944,25 @@ void sched_init(void)
     ltr(0);  // 加载任务0的tss 到各个寄存器
     lldt(0);  // 将局部描述表加载到局部描述符表寄存器
     // 初始化相关定时器
-    outb_p(0x36, 0x43);         /* binary, mode 3, LSB/MSB, ch 0 */
+    outb_p(0x34, 0x43);         /* binary, mode 2, LSB/MSB, ch 0 */
     outb_p(LATCH & 0xff, 0x40); /* LSB */
     outb(LATCH >> 8, 0x40);     /* MSB */
     set_intr_gate(0x20, &timer_interrupt);
     outb(inb_p(0x21) & ~0x01, 0x21);
+    hrtimer_init_rtc();
+    tsc_init();
+    if (tsc_khz)
+    {
+        rdtsc(tick_tsc);
+        acct_tsc = tick_tsc;
+    }
     set_system_gate(0x80, &system_call);
+    // CPU 支持时设置 sysenter 的入口。sysenter 不切换任务的栈，这里让 esp 指向 TSS 中的
+    // esp0，入口处从中取出当前任务的内核栈指针，这样切换任务时不用重写 MSR
+    if (__sysenter_probe())
+    {
+        wrmsr(MSR_SYSENTER_CS, 0x08, 0);
+        wrmsr(MSR_SYSENTER_ESP, (long)&init_task.task.tss.esp0, 0);
+        wrmsr(MSR_SYSENTER_EIP, (long)&sysenter_entry, 0);
+    }
 }
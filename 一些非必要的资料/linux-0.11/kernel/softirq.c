@@ -0,0 +1,56 @@
+/*
+ *  linux/kernel/softirq.c
+ */
+
+/*
+ * 中断的下半部(见 include/linux/interrupt.h)。
+ *
+ * do_bottom_half() 在中断和系统调用返回前调用(kernel/system_call.s、
+ * chr_drv/keyboard.S、chr_drv/rs_io.s)。下半部开着中断执行，期间到来的中断
+ * 再调用它时直接返回，新登记的下半部由外层接着执行，因此下半部之间不会嵌套，
+ * 彼此不必加锁；它们与硬件中断处理程序共用的数据仍要关中断访问。
+ */
+
+#include <linux/interrupt.h>
+#include <asm/system.h>
+
+unsigned long bh_active = 0;		//< 已登记、等待执行的下半部位图
+
+static void (*bh_base[32])(void);
+static int bh_running = 0;		//< 正在执行下半部
+
+/**
+ * @brief  设置下半部的处理函数
+ * @param  nr               下半部编号
+ * @param  routine          处理函数
+ */
+void init_bh(int nr, void (*routine)(void))
+{
+	bh_base[nr] = routine;
+}
+
+/**
+ * @brief  执行所有已登记的下半部，返回时中断标志与调用时相同
+ */
+void do_bottom_half(void)
+{
+	unsigned long active, flags;
+	void (**bh)(void);
+
+	if (bh_running)
+		return;
+	save_flags(flags);
+	bh_running = 1;
+	for (;;) {
+		cli();
+		if (!(active = bh_active))
+			break;
+		bh_active = 0;
+		sti();
+		for (bh = bh_base ; active ; bh++, active >>= 1)
+			if ((active & 1) && *bh)
+				(*bh)();
+	}
+	bh_running = 0;
+	restore_flags(flags);
+}
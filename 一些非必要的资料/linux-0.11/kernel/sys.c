@@ -9,9 +9,13 @@
 #include <linux/sched.h>
 #include <linux/tty.h>
 #include <linux/kernel.h>
+#include <linux/hrtimer.h>
 #include <asm/segment.h>
+#include <asm/div64.h>
 #include <sys/times.h>
+#include <sys/time.h>
 #include <sys/utsname.h>
+#include <time.h>
 // 返回日期和时间
 int sys_ftime()
 {
@@ -43,10 +47,6 @@ int sys_rename()
 	return -ENOSYS;
 }
 
-int sys_prof()
-{
-	return -ENOSYS;
-}
 /**
  * @brief  设置当前任务的实际/有效组ID(gid)
  * 如果任务没有超级用户特权只能互换实际组ID
@@ -211,6 +211,58 @@ int sys_times(struct tms * tbuf)
 	}
 	return jiffies;
 }
+
+/**
+ * @brief  取当前时间，精确到微秒
+ * 秒数是开机时的时间 startup_time 加上开机以来的时间 hr_now()
+ * @param  tv               不为空时在这里返回 1970 年以来的秒数和微秒数
+ * @param  tz               不为空时在这里返回时区，内核不记录时区，总是 0
+ * @return int              0
+ */
+int sys_gettimeofday(struct timeval * tv, struct timezone * tz)
+{
+	unsigned long long ns;
+	unsigned long nsec;
+
+	if (tv) {
+		ns = hr_now();
+		nsec = do_div(ns, NSEC_PER_SEC);
+		verify_area(tv, sizeof(*tv));
+		put_fs_long(startup_time + (unsigned long) ns, (unsigned long *) &tv->tv_sec);
+		put_fs_long(nsec / 1000, (unsigned long *) &tv->tv_usec);
+	}
+	if (tz) {
+		verify_area(tz, sizeof(*tz));
+		put_fs_long(0, (unsigned long *) &tz->tz_minuteswest);
+		put_fs_long(0, (unsigned long *) &tz->tz_dsttime);
+	}
+	return 0;
+}
+
+/**
+ * @brief  取时钟的当前值，精确到纳秒(实际精度取决于 hr_now())
+ * @param  which            CLOCK_REALTIME - 1970 年以来的时间，CLOCK_MONOTONIC - 开机以来的时间
+ * @param  tp               用户空间返回地址
+ * @return int              0，which 不正确时返回 -EINVAL
+ */
+int sys_clock_gettime(int which, struct timespec * tp)
+{
+	unsigned long long ns;
+	unsigned long nsec;
+
+	if (which != CLOCK_REALTIME && which != CLOCK_MONOTONIC)
+		return -EINVAL;
+	if (!tp)
+		return -EFAULT;
+	ns = hr_now();
+	nsec = do_div(ns, NSEC_PER_SEC);
+	if (which == CLOCK_REALTIME)
+		ns += startup_time;
+	verify_area(tp, sizeof(*tp));
+	put_fs_long((unsigned long) ns, (unsigned long *) &tp->tv_sec);
+	put_fs_long(nsec, (unsigned long *) &tp->tv_nsec);
+	return 0;
+}
 /**
  * @brief  设置进程末尾数据
  * @param  end_data_seg     末尾数据值
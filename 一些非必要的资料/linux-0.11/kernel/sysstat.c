@@ -0,0 +1,123 @@
+/*
+ *  linux/kernel/sysstat.c
+ */
+
+/*
+ * 系统调用的进出钩子和按调用号的统计。
+ *
+ * 系统调用跟踪点或统计打开时，kernel/system_call.s 在调用前后分别调用 syscall_enter()
+ * 和 syscall_exit()。统计记录每个调用号的次数、总时间、最长时间和按 2 的幂分档的时间
+ * 直方图，时间从进入到离开 system_call，有 TSC 时用 TSC 计时。开始的时间记在任务结构
+ * 中，睡眠的系统调用也能统计。内核态不会被抢占，这些计数只在进程上下文中修改，不用关中断。
+ */
+
+#include <errno.h>
+#include <sys/sysstat.h>
+
+#include <linux/sched.h>
+#include <linux/kernel.h>
+#include <linux/hrtimer.h>
+#include <linux/trace.h>
+#include <asm/system.h>
+#include <asm/segment.h>
+
+int sysstat_on = 0;	//< 不为 0 时统计(kernel/system_call.s 检查它)
+
+static struct sysstat stats[SYSSTAT_NR];
+
+/**
+ * @brief  当前时间：有 TSC 时是 TSC 值，否则是 hr_now() 的纳秒数
+ */
+static inline unsigned long long stamp(void)
+{
+	unsigned long long t;
+
+	if (!tsc_khz)
+		return hr_now();
+	rdtsc(t);
+	return t;
+}
+
+/**
+ * @brief  系统调用开始
+ * @param  nr               调用号
+ * @param  arg              第一个参数
+ */
+void syscall_enter(long nr, long arg)
+{
+	trace(TRACE_SYS_ENTER, nr, arg);
+	if (!sysstat_on || nr >= SYSSTAT_NR) {
+		current->sys_nr = -1;
+		return;
+	}
+	current->sys_nr = nr;
+	current->sys_start = stamp();
+}
+
+/**
+ * @brief  系统调用结束
+ * @param  ret              返回值
+ */
+void syscall_exit(long ret)
+{
+	struct sysstat * s;
+	unsigned long long d;
+	unsigned long ns;
+	int i;
+
+	trace(TRACE_SYS_EXIT, ret, 0);
+	if (current->sys_nr < 0)
+		return;
+	d = stamp() - current->sys_start;
+	if (tsc_khz)
+		ns = cycles_to_ns(d);
+	else
+		ns = (d > 0xffffffffULL) ? 0xffffffffUL : (unsigned long) d;
+	s = stats + current->sys_nr;
+	current->sys_nr = -1;
+	s->count++;
+	s->total += ns;
+	if (ns > s->max)
+		s->max = ns;
+	i = 0;
+	if (ns)
+		__asm__("bsrl %1,%0":"=r" (i):"r" (ns));
+	s->hist[i]++;
+}
+
+/**
+ * @brief  sysstat 系统调用：打开、关闭、清除或读出统计
+ * @param  cmd              SYSSTAT_OFF、SYSSTAT_ON、SYSSTAT_RESET 或 SYSSTAT_READ
+ * @param  buf              SYSSTAT_READ 时的用户缓冲区
+ * @param  n                SYSSTAT_READ 时最多复制的项数
+ * @return int              SYSSTAT_READ 返回复制的项数，其余返回 0，出错返回负的错误码
+ */
+int sys_sysstat(int cmd, struct sysstat * buf, int n)
+{
+	int i;
+
+	switch (cmd) {
+		case SYSSTAT_OFF:
+		case SYSSTAT_ON:
+		case SYSSTAT_RESET:
+			if (!suser())
+				return -EPERM;
+			if (cmd == SYSSTAT_RESET) {
+				for (i = 0 ; i < sizeof(stats) / 4 ; i++)
+					((unsigned long *) stats)[i] = 0;
+			} else
+				sysstat_on = cmd;
+			return 0;
+		case SYSSTAT_READ:
+			if (n < 0)
+				return -EINVAL;
+			if (n > SYSSTAT_NR)
+				n = SYSSTAT_NR;
+			verify_area(buf, n * sizeof(*buf));
+			for (i = 0 ; i < n * sizeof(*buf) / 4 ; i++)
+				put_fs_long(((unsigned long *) stats)[i],
+					i + (unsigned long *) buf);
+			return n;
+	}
+	return -EINVAL;
+}
@@ -62,6 +62,7 @@ priority = 8  /* 运行优先等级，任务开始时counter=priority,越大则
 signal	= 12 /* 对应信号值 */
 sigaction = 16		# MUST be 16 (=len of sigaction) /* 段页符号长度 */
 blocked = (33*16)  /* 受阻塞信号位图的偏移量 */
+prof_ticks = 1056  /* 未写入的剖析采样，task_struct 的最后几项之一，见 include/linux/sched.h */
 
 # offsets within sigaction 
 /* 定义在 sigaction 结构中的偏移量，参见 include/signal.h，第 48 行开始。 */
@@ -70,7 +71,8 @@ sa_mask = 4  /* 信号处理掩码 */
 sa_flags = 8  /* 对应信号集合 */
 sa_restorer = 12 /* 恢复函数指针，参见 kernel/signal.c */
 
-nr_system_calls = 72  /* linux 0.11 版内核中的系统调用总数 */
+nr_system_calls = 80  /* 内核中的系统调用总数(0.11 原为 72，加上 select、poll、setitimer、getitimer、nanosleep、gettimeofday、clock_gettime、sysstat) */
+TRACE_SYS_MASK = 0x180  /* 1<<TRACE_SYS_ENTER | 1<<TRACE_SYS_EXIT，见 include/linux/trace.h */
 
 /*
  * Ok, I get parallel printer interrupts while using the floppy for some
@@ -78,7 +80,8 @@ nr_system_calls = 72  /* linux 0.11 版内核中的系统调用总数 */
  */
  /* 对应函数链接定位符号 */
 .globl _system_call,_sys_fork,_timer_interrupt,_sys_execve
-.globl _hd_interrupt,_floppy_interrupt,_parallel_interrupt
+.globl _switch_stacks,_ret_from_fork,_sysenter_entry
+.globl _hd_interrupt,_floppy_interrupt,_parallel_interrupt,_rtc_interrupt
 .globl _device_not_available, _coprocessor_error
 /* 错误系统调用号 */
 .align 2   /* 内存 4字节对齐 */
@@ -89,6 +92,44 @@ bad_sys_call:
 reschedule:
 	pushl $ret_from_sys_call  /* 设置系统回调 */
 	jmp _schedule  /* 进入调度代码 */
+
+/*
+ * System call with the TRACE_SYS_ENTER/EXIT tracepoints or the per-call
+ * statistics enabled. The arguments stay where system_call pushed them,
+ * so the call itself is the same; the two C hooks only clobber eax, ecx
+ * and edx.
+ */
+/* 跟踪或统计系统调用：调用前后各调用一次钩子(kernel/sysstat.c) */
+.align 2
+hooked_sys_call:
+	pushl %eax		# syscall_enter(nr, ebx)
+	call _syscall_enter
+	popl %eax
+	call _sys_call_table(,%eax,4)
+	pushl %eax		# syscall_exit(ret)
+	call _syscall_exit
+	popl %eax
+	jmp sys_call_done
+
+/*
+ * sysenter comes here with interrupts off, cs = 0x08, ss = 0x10 and esp
+ * pointing at esp0 in the TSS (see sched_init()). The user stub passes
+ * its eip in esi and its esp in ebp (include/unistd.h). Build the same
+ * frame int 0x80 would have and go on as system_call: the return is
+ * always by iret, as sysexit can only return to flat segments and our
+ * user segments are in the LDT.
+ */
+/* sysenter 的入口：取当前任务的内核栈，构造与 int 0x80 相同的栈帧后转到 system_call */
+.align 2
+_sysenter_entry:
+	movl (%esp),%esp	# 当前任务的内核栈顶(TSS 中的 esp0)
+	pushl $0x17		# 用户态 ss
+	pushl %ebp		# 用户态 esp
+	pushfl
+	orl $0x200,(%esp)	# sysenter 清了 IF，返回用户态时要开中断
+	pushl $0x0f		# 用户态 cs
+	pushl %esi		# 用户态 eip
+	sti
 .align 2
 _system_call:
 	cmpl $nr_system_calls-1,%eax  /* 对系统调用号-1， */
@@ -104,7 +145,17 @@ _system_call:
 	mov %dx,%es
 	movl $0x17,%edx		# fs points to local data space /* fs指向局部数据段 */
 	mov %dx,%fs
+	cmpl $0,_tsc_khz		# charge the time so far as user time (kernel/sched.c)
+	je 1f
+	pushl %eax
+	call _account_entry
+	popl %eax
+1:	testl $TRACE_SYS_MASK,_trace_mask	/* 跟踪或统计系统调用时走 hooked_sys_call */
+	jne hooked_sys_call
+	cmpl $0,_sysstat_on
+	jne hooked_sys_call
 	call _sys_call_table(,%eax,4)  /* 查询系统调用表对应函数,进行调用 调用地址 = _sys_call_table + %eax *4 */
+sys_call_done:
 	pushl %eax    /* 将函数返回值入栈 */
 	movl _current,%eax  /* 将当前任务(进程)数据地址放入 eax */
 	cmpl $0,state(%eax)		# state /* 检查当前状态是否为0 */
@@ -113,7 +164,10 @@ _system_call:
 	je reschedule  /* 进行重新调用 */
 /* 系统调用结束后，对信号量进行处理 */
 ret_from_sys_call:
-	movl _current,%eax		# task[0] cannot have signals
+	cmpl $0,_bh_active		# deferred interrupt work? (kernel/softirq.c)
+	je 4f
+	call _do_bottom_half
+4:	movl _current,%eax		# task[0] cannot have signals
 	cmpl _task,%eax /* 判断不是为0号任务，直接返回 */
 	je 3f  /* 跳转到代码3直接结束 */
 /* 
@@ -126,6 +180,11 @@ ret_from_sys_call:
 	jne 3f
 	cmpw $0x17,OLDSS(%esp)		# was stack segment = 0x17 ?/* 如果原堆栈段选择符号不在用户数据段中，进行推出 */
 	jne 3f
+	cmpl $0,prof_ticks(%eax)	# profiling samples to store? /* 把时钟中断中记下的剖析采样写入用户空间(kernel/prof.c) */
+	je 2f
+	call _prof_flush
+	movl _current,%eax
+2:
 /*
     查询当前任务结构的信号位图
     使用任务结构中的信号阻塞(屏蔽)码，阻塞不允许的信号位，取得数值最小的信号值
@@ -136,13 +195,16 @@ ret_from_sys_call:
 	notl %ecx  /* 每位进行取反 */
 	andl %ebx,%ecx  /* 获取许可的信号位图 */
 	bsfl %ecx,%ecx  /* 位（位 0）开始扫描位图，看是否有 1 的位，有，则 ecx 保留该位的偏移值（即第几位 0-31） */
-	je 3f  /* 没有信号位，保留偏移值进行退出 */
+	je 5f  /* 没有信号位，保留偏移值进行退出 */
 	btrl %ecx,%ebx  /* 包含信号位进行复位 */
 	movl %ebx,signal(%eax)  /* 重新保存signal 位图信息 -> current-> signal */
 	incl %ecx /* 将信号调整为从1开始的数(1-32) */
 	pushl %ecx  /* 信号值入栈，作为_do_signal 的参数 */
 	call _do_signal  /* 调用信号处理函数 */
 	popl %eax /* 弹出信号值 */
+5:	cmpl $0,_tsc_khz		# back to user mode: the time since entry was
+	je 3f				# system time (kernel/sched.c)
+	call _account_exit
 3:	popl %eax    /* 将保存的寄存器进行恢复  */
 	popl %ebx
 	popl %ecx
@@ -213,7 +275,7 @@ _device_not_available:
 int32 -- (int 0x20) 时钟中断处理程序，中断频率设置未100Hz(include/linux/sched.h,5),
 定时芯片253/8254 是在(kernel/sched.c,406)处初始化的。因此这里 jiffies 每 10 毫秒加1
 这段代码将 jiffies 增 1，发送结束中断指令给 8259 控制器，然后用当前特权级作为参数调用
-C函数 do_timer(long CPL)。当调用返回时转去检测并处理信号。
+C函数 do_timer(long CPL, long EIP)。当调用返回时转去检测并处理信号。
 */
 
 .align 2
@@ -235,9 +297,11 @@ _timer_interrupt:
 	outb %al,$0x20  /* 发送指令到0x20端口 */
 	movl CS(%esp),%eax
 	andl $3,%eax		# %eax is CPL (0 or 3, 0=supervisor)
+	movl EIP(%esp),%ebx	# interrupted pc, for profiling  /* 被中断代码的地址，用于剖析(kernel/prof.c) */
+	pushl %ebx
 	pushl %eax
-	call _do_timer		# 'do_timer(long CPL)' does everything from  /* o_timer(CPL)执行任务切换、计时等工作，在 kernel/shched.c,305 行实现 */
-	addl $4,%esp		# task switching to accounting ...
+	call _do_timer		# 'do_timer(long CPL, long EIP)' does everything from  /* do_timer(CPL, EIP)执行任务切换、计时等工作，在 kernel/sched.c 中实现 */
+	addl $8,%esp		# task switching to accounting ...
 	jmp ret_from_sys_call
 
 /*
@@ -272,13 +336,57 @@ _sys_fork:
 	call _copy_process /* C 函数 copy_process()(kernel/fork.c,68)。*/
 	addl $20,%esp  /* 丢弃这里所有压栈内容 */
 1:	ret
+
+/*
+ * void switch_stacks(long * save_esp, long new_esp)
+ *
+ * The software task switch (switch_to() in sched.c): save the callee
+ * saved registers and fs/gs on this kernel stack, store its esp in
+ * *save_esp and return on the stack at new_esp - to wherever that task
+ * called switch_stacks(), or to ret_from_fork for a new one.
+ *
+ * fs and gs have to be reloaded even when the selector is the same:
+ * the LDT changed underneath them, and the descriptor cache (with the
+ * old task's base) is only refreshed by a segment load.
+ */
+/* 交换内核栈：保存 ebx、esi、edi、ebp、fs、gs 和栈指针，换到 new_esp 上恢复并返回。
+ * LDT 已经换了，fs、gs 必须重新装入，段描述符高速缓存中的基址才是新任务的 */
+.align 2
+_switch_stacks:
+	pushl %ebp
+	pushl %edi
+	pushl %esi
+	pushl %ebx
+	push %fs
+	push %gs
+	movl 28(%esp),%eax	# save_esp
+	movl 32(%esp),%edx	# new_esp
+	movl %esp,(%eax)
+	movl %edx,%esp
+	pop %gs
+	pop %fs
+	popl %ebx
+	popl %esi
+	popl %edi
+	popl %ebp
+	ret
+
+/*
+ * A new task starts here: copy_process() left a complete
+ * ret_from_sys_call frame (with eax = 0) on its kernel stack.
+ */
+/* 新任务第一次运行从这里开始：copy_process() 在其内核栈上放好了返回用户态的栈帧 */
+.align 2
+_ret_from_fork:
+	sti
+	jmp ret_from_sys_call
 /*
 int 46 -- (int 0x2E) 硬盘中断处理程序，响应硬件中断请求IRQ14。     
 当硬盘操作完成或出错就会发出此中断信号。(参见 kernel/blk_drv/hd.c)。     
 首先向 8259A 中断控制从芯片发送结束硬件中断指令(EOI)，然后取变量 do_hd 中的函数指针放入 edx     
-寄存器中，并置 do_hd 为 NULL，接着判断 edx 函数指针是否为空。如果为空，则给 edx 赋值指向
-unexpected_hd_interrupt()，用于显示出错信息。随后向 8259A 主芯片送 EOI 指令，并调用 edx 中     
-指针指向的函数: read_intr()、write_intr()或 unexpected_hd_interrupt()。
+寄存器中，并置 do_hd 为 NULL。随后向 8259A 主芯片送 EOI 指令，调用 hd_intr() 读状态寄存器应答
+驱动器，并把 edx 中的函数(read_intr()、write_intr() 等，为空时是 unexpected_hd_interrupt())
+登记为下半部。数据传输和下一个请求都在开中断的下半部中进行(kernel/softirq.c)。
 */
 _hd_interrupt:
 	pushl %eax
@@ -298,12 +406,14 @@ _hd_interrupt:
 1:	jmp 1f
 1:	xorl %edx,%edx
 	xchgl _do_hd,%edx /* do_hd 定义为一个函数指针，将被赋值 read_intr()或write_intr()函数地址。(kernel/blk_drv/hd.c) 放到 edx 寄存器后就将 do_hd 指针变量置为NULL   */
-	testl %edx,%edx   /* 检测函数指针是否为NULL */
-	jne 1f  /* 若空，则使指针指向C 函数 unexpected_hd_interrupt()。 */
-	movl $_unexpected_hd_interrupt,%edx /* 输出错误信息 */
-1:	outb %al,$0x20   /* 送主8259A 中断控制器EOI指令(结束硬件中断) */
-	call *%edx		# "interesting" way of handling intr. /* 调用do_hd 指向函数 */
-	pop %fs  /* 恢复栈内容 */
+	outb %al,$0x20   /* 送主8259A 中断控制器EOI指令(结束硬件中断) */
+	pushl %edx
+	call _hd_intr		# ack the drive, defer *do_hd to the bottom half /* 应答驱动器，do_hd 留给下半部执行 */
+	popl %edx
+	cmpl $0,_bh_active
+	je 1f
+	call _do_bottom_half	/* 开着中断执行下半部 */
+1:	pop %fs  /* 恢复栈内容 */
 	pop %es
 	pop %ds
 	popl %edx
@@ -357,3 +467,37 @@ _parallel_interrupt:
 	outb %al,$0x20
 	popl %eax
 	iret
+
+/*
+ * int40 -- (int 0x28) RTC 中断，IRQ8。只有高精度定时器快要到期时才打开周期中断，
+ * 由 C 函数 do_rtc()(kernel/hrtimer.c)应答并执行到期的定时器。
+ */
+.align 2
+_rtc_interrupt:
+	pushl %eax
+	pushl %ecx
+	pushl %edx
+	push %ds
+	push %es
+	push %fs
+	movl $0x10,%eax
+	mov %ax,%ds
+	mov %ax,%es
+	movl $0x17,%eax
+	mov %ax,%fs
+	movb $0x20,%al
+	outb %al,$0xA0		# EOI to interrupt controller #2
+	jmp 1f
+1:	jmp 1f
+1:	outb %al,$0x20		# EOI to interrupt controller #1
+	call _do_rtc
+	cmpl $0,_bh_active	# a timer may have marked a bottom half
+	je 1f
+	call _do_bottom_half
+1:	pop %fs
+	pop %es
+	pop %ds
+	popl %edx
+	popl %ecx
+	popl %eax
+	iret
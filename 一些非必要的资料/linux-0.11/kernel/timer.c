@@ -0,0 +1,288 @@
+/*
+ *  linux/kernel/timer.c
+ */
+
+/*
+ * The timer wheel. tv1 has one bucket for each of the next 256 ticks;
+ * tv2-tv5 have 64 buckets each, covering 64 times the span of the level
+ * below. A timer goes into the bucket of the lowest level that reaches
+ * its expiry time. Each time tv1 wraps, the next bucket of tv2 is
+ * emptied into tv1 (and so on upwards), so a timer is looked at no more
+ * than once per level on its way down.
+ */
+
+/*
+ * 定时器轮。tv1 为以后 256 个滴答各设一个桶，tv2-tv5 各 64 个桶，每级覆盖的时间是
+ * 下一级的 64 倍。定时器放入能覆盖其到期时间的最低一级的桶中；tv1 每转一圈，就把
+ * tv2 的下一个桶重新分配到 tv1 中(依次向上)。加入、删除都是 O(1)。
+ */
+
+#include <linux/sched.h>
+#include <linux/kernel.h>
+#include <linux/mm.h>
+#include <linux/timer.h>
+#include <asm/system.h>
+
+#define TVN_BITS 6
+#define TVR_BITS 8
+#define TVN_SIZE (1 << TVN_BITS)
+#define TVR_SIZE (1 << TVR_BITS)
+#define TVN_MASK (TVN_SIZE - 1)
+#define TVR_MASK (TVR_SIZE - 1)
+
+/**
+ * @brief 定时器轮的一级
+ */
+struct timer_vec {
+	int index;				//< 下一个要处理的桶
+	struct timer_list * vec[TVN_SIZE];
+};
+
+/**
+ * @brief 最低一级，每个滴答一个桶
+ */
+struct timer_vec_root {
+	int index;
+	struct timer_list * vec[TVR_SIZE];
+};
+
+static struct timer_vec_root tv1;
+static struct timer_vec tv2, tv3, tv4, tv5;
+
+static struct timer_vec * const tvecs[] = {
+	(struct timer_vec *) &tv1, &tv2, &tv3, &tv4, &tv5
+};
+
+#define NOOF_TVECS (sizeof(tvecs) / sizeof(tvecs[0]))
+
+/**
+ * @brief 定时器轮已经处理到的时间，run_timers() 把它追到 jiffies
+ */
+static unsigned long timer_jiffies = 0;
+
+/**
+ * @brief  把定时器放入对应的桶中，调用者负责关中断
+ * @param  timer            定时器
+ */
+static void internal_add_timer(struct timer_list * timer)
+{
+	unsigned long expires = timer->expires;
+	unsigned long idx = expires - timer_jiffies;
+	struct timer_list ** vec;
+
+	if (idx < TVR_SIZE)
+		vec = tv1.vec + (expires & TVR_MASK);
+	else if (idx < 1 << (TVR_BITS + TVN_BITS))
+		vec = tv2.vec + ((expires >> TVR_BITS) & TVN_MASK);
+	else if (idx < 1 << (TVR_BITS + 2 * TVN_BITS))
+		vec = tv3.vec + ((expires >> (TVR_BITS + TVN_BITS)) & TVN_MASK);
+	else if (idx < 1 << (TVR_BITS + 3 * TVN_BITS))
+		vec = tv4.vec + ((expires >> (TVR_BITS + 2 * TVN_BITS)) & TVN_MASK);
+	else if ((long) idx < 0)
+		// 已经过期：放在马上要处理的桶里，下一个滴答执行
+		vec = tv1.vec + tv1.index;
+	else
+		vec = tv5.vec + ((expires >> (TVR_BITS + 3 * TVN_BITS)) & TVN_MASK);
+	if ((timer->next = *vec))
+		(*vec)->pprev = &timer->next;
+	*vec = timer;
+	timer->pprev = vec;
+}
+
+/**
+ * @brief  从所在的桶中摘下定时器，调用者负责关中断
+ * @return int              1 - 定时器原来在等待，0 - 不在
+ */
+static int detach_timer(struct timer_list * timer)
+{
+	if (!timer->pprev)
+		return 0;
+	if (timer->next)
+		timer->next->pprev = timer->pprev;
+	*timer->pprev = timer->next;
+	timer->pprev = NULL;
+	return 1;
+}
+
+/**
+ * @brief  初始化定时器
+ * @param  timer            定时器
+ * @param  function         到期时调用的函数
+ * @param  data             传给 function 的参数
+ */
+void init_timer(struct timer_list * timer,
+	void (*function)(unsigned long), unsigned long data)
+{
+	timer->next = NULL;
+	timer->pprev = NULL;
+	timer->expires = 0;
+	timer->function = function;
+	timer->data = data;
+}
+
+/**
+ * @brief  (重新)启动定时器，已经在等待的先取消
+ * @param  timer            定时器
+ * @param  expires          到期的 jiffies 值
+ */
+void mod_timer(struct timer_list * timer, unsigned long expires)
+{
+	unsigned long flags;
+
+	save_flags(flags);
+	cli();
+	detach_timer(timer);
+	timer->expires = expires;
+	internal_add_timer(timer);
+	restore_flags(flags);
+}
+
+/**
+ * @brief  取消定时器
+ * @param  timer            定时器
+ * @return int              1 - 定时器原来在等待，0 - 已经到期或没有启动
+ */
+int del_timer(struct timer_list * timer)
+{
+	unsigned long flags;
+	int ret;
+
+	save_flags(flags);
+	cli();
+	ret = detach_timer(timer);
+	restore_flags(flags);
+	return ret;
+}
+
+/**
+ * @brief  把上一级的下一个桶重新分配到下面各级
+ * @param  tv               上一级
+ */
+static void cascade_timers(struct timer_vec * tv)
+{
+	struct timer_list * timer, * next;
+
+	timer = tv->vec[tv->index];
+	tv->vec[tv->index] = NULL;
+	while (timer) {
+		next = timer->next;
+		internal_add_timer(timer);
+		timer = next;
+	}
+	tv->index = (tv->index + 1) & TVN_MASK;
+}
+
+/**
+ * @brief  执行所有到期的定时器，由 do_timer() 在关中断的情况下调用
+ */
+void run_timers(void)
+{
+	struct timer_list * timer;
+	void (*fn)(unsigned long);
+	int n;
+
+	while ((long) (jiffies - timer_jiffies) >= 0) {
+		if (!tv1.index) {
+			n = 1;
+			do {
+				cascade_timers(tvecs[n]);
+			} while (tvecs[n]->index == 1 && ++n < NOOF_TVECS);
+		}
+		while ((timer = tv1.vec[tv1.index])) {
+			detach_timer(timer);
+			fn = timer->function;
+			(fn)(timer->data);
+		}
+		timer_jiffies++;
+		tv1.index = (tv1.index + 1) & TVR_MASK;
+	}
+}
+
+/**
+ * @brief  求必须运行 run_timers() 的下一个 jiffies 值，最多向后查看 max 个滴答
+ * 用于空闲时减少时钟中断(kernel/sched.c)，调用者负责关中断。tv1 转回 0 号桶时上一级
+ * 的定时器会被重新分配下来，可能正好在那时到期，所以也算作一个必须处理的时刻，
+ * 包括下一个要处理的就是 0 号桶的情况。
+ * @param  max              最多查看的滴答数
+ * @return unsigned long    jiffies 值
+ */
+unsigned long next_timer_jiffies(unsigned long max)
+{
+	unsigned long i;
+	int idx;
+
+	for (i = 0 ; i < max ; i++) {
+		idx = (tv1.index + i) & TVR_MASK;
+		if (tv1.vec[idx] || !idx)
+			break;
+	}
+	return timer_jiffies + i;
+}
+
+/*
+ * add_timer() entries. They are taken from a free list that grows a
+ * page at a time, so there is no fixed limit on pending requests.
+ */
+
+/**
+ * @brief add_timer() 使用的定时器项
+ */
+struct timer_request {
+	struct timer_list timer;
+	void (*fn)(void);
+	struct timer_request * next_free;
+};
+
+static struct timer_request * free_requests = NULL;
+
+/**
+ * @brief  add_timer() 定时器的处理函数：先释放定时器项，再调用请求的函数
+ * @param  data             定时器项地址
+ */
+static void timer_request_fn(unsigned long data)
+{
+	struct timer_request * req = (struct timer_request *) data;
+	void (*fn)(void) = req->fn;
+
+	req->next_free = free_requests;
+	free_requests = req;
+	(fn)();
+}
+
+/**
+ * @brief  增加定时器
+ * @param  ticks            多少个滴答之后执行
+ * @param  fn               对应的执行处理函数
+ */
+void add_timer(long ticks, void (*fn)(void))
+{
+	struct timer_request * req;
+	unsigned long page, flags;
+	int i;
+
+	if (!fn)
+		return;
+	save_flags(flags);
+	cli();
+	if (ticks <= 0) {
+		(fn)();
+		restore_flags(flags);
+		return;
+	}
+	if (!free_requests) {
+		if (!(page = get_free_page()))
+			panic("No more time requests free");
+		req = (struct timer_request *) page;
+		for (i = 0 ; i < PAGE_SIZE / sizeof(*req) ; i++, req++) {
+			req->next_free = free_requests;
+			free_requests = req;
+		}
+	}
+	req = free_requests;
+	free_requests = req->next_free;
+	req->fn = fn;
+	init_timer(&req->timer, timer_request_fn, (unsigned long) req);
+	req->timer.expires = jiffies + ticks;
+	internal_add_timer(&req->timer);
+	restore_flags(flags);
+}
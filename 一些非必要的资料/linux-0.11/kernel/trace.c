@@ -0,0 +1,154 @@
+/*
+ *  linux/kernel/trace.c
+ */
+
+/*
+ * 跟踪记录的环形缓冲区，说明见 <linux/trace.h>。
+ *
+ * trace_head、trace_tail 是一直增加的写、读计数，取低位作为下标，两者之差就是缓冲区中
+ * 的记录数。写记录时关中断，可以在任何地方(包括中断处理中)调用。
+ */
+
+#include <errno.h>
+
+#include <linux/sched.h>
+#include <linux/kernel.h>
+#include <linux/fs.h>
+#include <linux/hrtimer.h>
+#include <linux/trace.h>
+#include <asm/system.h>
+#include <asm/segment.h>
+#include <asm/io.h>
+#include <asm/div64.h>
+
+#define TRACE_SIZE	1024	/* 记录数，必须是 2 的幂 */
+#define TRACE_PORT	0x3f8	/* 串口 1 */
+
+unsigned long trace_mask = 0;	//< 打开的事件，位 n 对应事件 n
+
+static struct trace_rec trace_buf[TRACE_SIZE];
+static unsigned long trace_head = 0, trace_tail = 0;
+static unsigned long trace_lost = 0;	//< 读者还不知道的被覆盖的记录数
+
+/**
+ * @brief  写一条跟踪记录，由 trace() 在事件打开时调用
+ * @param  event            事件
+ * @param  a                参数 a
+ * @param  b                参数 b
+ */
+void __trace(int event, unsigned long a, unsigned long b)
+{
+	struct trace_rec * r;
+	unsigned long long t;
+	unsigned long flags;
+
+	t = hr_now();
+	do_div(t, 1000);
+	save_flags(flags);
+	cli();
+	if (trace_head - trace_tail == TRACE_SIZE) {
+		trace_tail++;
+		trace_lost++;
+	}
+	r = trace_buf + (trace_head++ & (TRACE_SIZE - 1));
+	r->time = (unsigned long) t;
+	r->event = event;
+	r->pid = current->pid;
+	r->a = a;
+	r->b = b;
+	restore_flags(flags);
+}
+
+/**
+ * @brief  取出最早的一条记录，有记录被覆盖时先取出一条 TRACE_LOST
+ * @param  r                返回的记录
+ * @return int              1 - 取到，0 - 缓冲区空
+ */
+static int get_rec(struct trace_rec * r)
+{
+	unsigned long flags;
+	int ret = 1;
+
+	save_flags(flags);
+	cli();
+	if (trace_lost) {
+		r->time = trace_buf[trace_tail & (TRACE_SIZE - 1)].time;
+		r->event = TRACE_LOST;
+		r->pid = 0;
+		r->a = trace_lost;
+		r->b = 0;
+		trace_lost = 0;
+	} else if (trace_tail != trace_head)
+		*r = trace_buf[trace_tail++ & (TRACE_SIZE - 1)];
+	else
+		ret = 0;
+	restore_flags(flags);
+	return ret;
+}
+
+/**
+ * @brief  /dev/trace 的读写，由 fs/char_dev.c 中的 rw_memory() 调用
+ * 读取出整条的记录，没有记录时返回 0(不等待)；写入 4 字节的事件掩码(只限超级用户)
+ * @param  rw               READ 或 WRITE
+ * @param  buf              用户缓冲区
+ * @param  count            字节数
+ * @return int              读写的字节数，出错返回负的错误码
+ */
+int rw_trace(int rw, char * buf, int count)
+{
+	struct trace_rec r;
+	int n, i;
+
+	if (rw == WRITE) {
+		if (!suser())
+			return -EPERM;
+		if (count < 4)
+			return -EINVAL;
+		trace_mask = get_fs_long((unsigned long *) buf);
+		return count;
+	}
+	verify_area(buf, count);
+	for (n = 0 ; count - n >= sizeof(r) && get_rec(&r) ; n += sizeof(r))
+		for (i = 0 ; i < sizeof(r) ; i += 4)
+			put_fs_long(*(unsigned long *) (i + (char *) &r),
+				(unsigned long *) (n + i + buf));
+	return n;
+}
+
+/**
+ * @brief  查询方式从串口 1 输出一个字符
+ */
+static void serial_putc(char c)
+{
+	while (!(inb(TRACE_PORT + 5) & 0x20))	/* 等待发送保持寄存器空 */
+		/* nothing */ ;
+	outb(c, TRACE_PORT);
+}
+
+/**
+ * @brief  把缓冲区中的记录以十六进制从串口 1 输出并取出，由 show_stat() 调用
+ * 系统已经不能运行用户程序时也能取得记录。每条记录一行："@T " 加上记录的 16 个字节
+ * (内存中的顺序)。用查询方式输出，期间一直关中断
+ */
+void trace_dump(void)
+{
+	static char hex[] = "0123456789abcdef";
+	struct trace_rec r;
+	unsigned long flags;
+	int i;
+
+	save_flags(flags);
+	cli();
+	while (get_rec(&r)) {
+		serial_putc('@');
+		serial_putc('T');
+		serial_putc(' ');
+		for (i = 0 ; i < sizeof(r) ; i++) {
+			serial_putc(hex[((unsigned char *) &r)[i] >> 4]);
+			serial_putc(hex[((unsigned char *) &r)[i] & 15]);
+		}
+		serial_putc('\r');
+		serial_putc('\n');
+	}
+	restore_flags(flags);
+}
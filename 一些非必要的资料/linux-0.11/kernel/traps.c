@@ -105,9 +105,11 @@ static void die(char * str,long esp_ptr,long nr)
 			printk("%p ",get_seg_long(0x17,i+(long *)esp[3]));
 		printk("\n");
 	}
-	str(i);
+	// 只有一个 TSS，任务号不能再从 TR 得到，在任务数组中查找
+	for (i=0 ; i<NR_TASKS && task[i]!=current ; i++)
+		/* nothing */ ;
 	// 打印PID、任务号
-	printk("Pid: %d, process nr: %d\n\r",current->pid,0xffff & i);
+	printk("Pid: %d, process nr: %d\n\r",current->pid,i);
 	// 打印10字节指令码
 	for(i=0;i<10;i++)
 		printk("%02x ",0xff & get_seg_byte(esp[1],(i+(char *)esp[0])));
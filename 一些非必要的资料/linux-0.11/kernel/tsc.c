@@ -0,0 +1,87 @@
+/*
+ *  linux/kernel/tsc.c
+ */
+
+/*
+ * 时间戳计数器(TSC)。开机时用 8253 计数器 2 校准它的频率，之后 hr_now() 和进程的
+ * CPU 时间统计都用它：读 TSC 只要几十个时钟周期，而锁存、读出 8253 要好几次慢速的
+ * I/O 操作。没有 TSC 的 CPU 上 tsc_khz 为 0，调用者退回到读 8253 和按滴答计时。
+ */
+
+#include <linux/sched.h>
+#include <linux/kernel.h>
+#include <linux/hrtimer.h>
+#include <asm/system.h>
+#include <asm/io.h>
+#include <asm/div64.h>
+
+#define CPUID_TSC	0x00000010	/* cpuid(1) edx 第 4 位：有 rdtsc 指令 */
+
+#define CALIBRATE_MS	50
+#define CALIBRATE_LATCH	(1193180 / (1000 / CALIBRATE_MS))
+#define CALIBRATE_LOOPS	4000000	/* 读 0x61 的最多次数，每次约 1 微秒，远大于 50 毫秒 */
+
+/**
+ * @brief TSC 的频率(kHz)，0 表示没有 TSC
+ */
+unsigned long tsc_khz = 0;
+
+static unsigned long cyc2ns_scale;	//< 纳秒数 = (周期数 * cyc2ns_scale) >> 16
+
+/**
+ * @brief  TSC 周期数换算成纳秒，超过 32 位的按最大值算(约 4 秒以上)
+ * 只用于两次读 TSC 之间的短时间间隔
+ * @param  cycles           周期数
+ * @return unsigned long    纳秒数
+ */
+unsigned long cycles_to_ns(unsigned long long cycles)
+{
+	if (cycles > 0xffffffffULL)
+		cycles = 0xffffffffULL;
+	return ((unsigned long) cycles * (unsigned long long) cyc2ns_scale) >> 16;
+}
+
+/**
+ * @brief  检测 TSC 并校准它的频率，由 sched_init() 调用
+ * 让 8253 计数器 2 以方式 0 计数 50 毫秒(门控打开，扬声器关闭)，计数结束时 0x61
+ * 端口的位 5(OUT2)变为 1，数出这段时间里 TSC 走了多少。OUT2 一直不变时 tsc_khz
+ * 保持为 0
+ */
+void tsc_init(void)
+{
+	unsigned long a, b, c, d, flags, n;
+	unsigned long long t0, t1, scale;
+	unsigned char old61;
+
+	if (!has_cpuid())
+		return;
+	cpuid(1, a, b, c, d);
+	if (!(d & CPUID_TSC))
+		return;
+	save_flags(flags);
+	cli();
+	old61 = inb_p(0x61);
+	outb_p((old61 & ~0x02) | 0x01, 0x61);
+	outb_p(0xb0, 0x43);			/* binary, mode 0, LSB/MSB, ch 2 */
+	outb_p(CALIBRATE_LATCH & 0xff, 0x42);
+	outb(CALIBRATE_LATCH >> 8, 0x42);
+	rdtsc(t0);
+	for (n = 0 ; n < CALIBRATE_LOOPS && !(inb(0x61) & 0x20) ; n++)
+		/* nothing */ ;
+	rdtsc(t1);
+	outb(old61, 0x61);
+	restore_flags(flags);
+	// 有的主板或模拟器没有把 OUT2 接到 0x61，这时不用 TSC，只用 8253 计时
+	if (n >= CALIBRATE_LOOPS) {
+		printk("TSC: PIT channel 2 does not count, not using TSC\n\r");
+		return;
+	}
+	t1 -= t0;
+	do_div(t1, CALIBRATE_MS);
+	if (!(tsc_khz = (unsigned long) t1))
+		return;
+	scale = 1000000ULL << 16;
+	do_div(scale, tsc_khz);
+	cyc2ns_scale = (unsigned long) scale;
+	printk("TSC: %d.%03d MHz\n\r", tsc_khz / 1000, tsc_khz % 1000);
+}
@@ -0,0 +1,9 @@
+/*
+ *  linux/lib/clock_gettime.c
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <time.h>
+
+_syscall2(int,clock_gettime,clockid_t,clk,struct timespec *,tp)
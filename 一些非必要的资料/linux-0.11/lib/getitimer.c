@@ -0,0 +1,9 @@
+/*
+ *  linux/lib/getitimer.c
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <sys/time.h>
+
+_syscall2(int,getitimer,int,which,struct itimerval *,value)
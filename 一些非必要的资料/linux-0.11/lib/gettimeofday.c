@@ -0,0 +1,9 @@
+/*
+ *  linux/lib/gettimeofday.c
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <sys/time.h>
+
+_syscall2(int,gettimeofday,struct timeval *,tv,struct timezone *,tz)
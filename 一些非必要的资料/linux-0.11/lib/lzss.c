@@ -0,0 +1,44 @@
+/*
+ *  linux/lib/lzss.c
+ */
+
+/*
+ * LZSS 解压缩，格式见 include/linux/lzss.h。
+ * 输出区本身就是滑动窗口，匹配项直接从已输出的数据中复制，不需要额外的缓冲区。
+ */
+
+#include <linux/lzss.h>
+
+long lzss_decode(char * out, long size, int (*getb)(void))
+{
+	char * p = out, * end = out + size;
+	unsigned int flags = 0;
+	int c, d;
+	long dist, len;
+
+	while (p < end) {
+		// 标志字节的 8 位用完后(哨兵位 0x100 移出)读入下一个标志字节
+		if (!((flags >>= 1) & 0x100)) {
+			if ((c = getb()) < 0)
+				break;
+			flags = c | 0xff00;
+		}
+		if ((c = getb()) < 0)
+			break;
+		if (flags & 1) {
+			*p++ = c;
+			continue;
+		}
+		if ((d = getb()) < 0)
+			break;
+		dist = (((d & 0xf0) << 4) | c) + 1;
+		len = (d & 0x0f) + LZSS_MIN_MATCH;
+		if (dist > p - out)
+			return -1;
+		while (len-- && p < end) {
+			*p = *(p - dist);
+			p++;
+		}
+	}
+	return p - out;
+}
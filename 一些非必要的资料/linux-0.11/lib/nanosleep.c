@@ -0,0 +1,9 @@
+/*
+ *  linux/lib/nanosleep.c
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <time.h>
+
+_syscall2(int,nanosleep,const struct timespec *,req,struct timespec *,rem)
@@ -14,10 +14,7 @@ int open(const char * filename, int flag, ...)
 	va_list arg;
 
 	va_start(arg,flag);
-	__asm__("int $0x80"
-		:"=a" (res)
-		:"0" (__NR_open),"b" (filename),"c" (flag),
-		"d" (va_arg(arg,int)));
+	__syscall(res,__NR_open,filename,flag,va_arg(arg,int));
 	if (res>=0)
 		return res;
 	errno = -res;
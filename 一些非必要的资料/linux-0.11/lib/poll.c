@@ -0,0 +1,9 @@
+/*
+ *  linux/lib/poll.c
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <sys/poll.h>
+
+_syscall3(int,poll,struct pollfd *,fds,unsigned long,nfds,int,timeout)
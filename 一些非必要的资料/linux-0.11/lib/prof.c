@@ -0,0 +1,9 @@
+/*
+ *  linux/lib/prof.c
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <sys/prof.h>
+
+_syscall2(int,prof,int,which,struct prof *,pr)
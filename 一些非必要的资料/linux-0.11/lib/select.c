@@ -0,0 +1,32 @@
+/*
+ *  linux/lib/select.c
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <sys/time.h>
+
+/*
+ * select() 有 5 个参数，超过了 _syscallN 宏可用的寄存器个数，
+ * 因此把参数依次放在栈上，只把它们的首地址传给内核(sys_select)。
+ */
+int select(int width, fd_set * readfds, fd_set * writefds,
+	fd_set * exceptfds, struct timeval * timeout)
+{
+	register int res;
+	long buffer[5];
+
+	buffer[0] = width;
+	buffer[1] = (long) readfds;
+	buffer[2] = (long) writefds;
+	buffer[3] = (long) exceptfds;
+	buffer[4] = (long) timeout;
+	__asm__("int $0x80"
+		:"=a" (res)
+		:"0" (__NR_select),"b" (buffer)
+		:"memory");
+	if (res>=0)
+		return res;
+	errno = -res;
+	return -1;
+}
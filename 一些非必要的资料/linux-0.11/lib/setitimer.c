@@ -0,0 +1,9 @@
+/*
+ *  linux/lib/setitimer.c
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <sys/time.h>
+
+_syscall3(int,setitimer,int,which,struct itimerval *,value,struct itimerval *,ovalue)
@@ -0,0 +1,39 @@
+/*
+ *  linux/lib/sysenter.c
+ */
+
+/*
+ * 决定系统调用用 sysenter 还是 int 0x80(见 include/unistd.h 中的 __syscall)。
+ * 内核在 sched_init() 中用同一个函数决定是否设置 sysenter 的 MSR，因此两边的
+ * 判断总是一致的。
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <asm/system.h>
+
+#define CPUID_SEP	0x00000800	/* cpuid(1) edx 第 11 位：支持 sysenter/sysexit */
+
+/**
+ * @brief 1 - 使用 sysenter，0 - 使用 int 0x80，-1 - 还没有检测
+ */
+int __sysenter_ok = -1;
+
+/**
+ * @brief  检测 CPU 是否支持 sysenter，结果记录在 __sysenter_ok 中
+ * @return int              1 - 支持，0 - 不支持
+ */
+int __sysenter_probe(void)
+{
+	unsigned long a, b, c, d;
+
+	if (!has_cpuid())
+		return __sysenter_ok = 0;
+	cpuid(1, a, b, c, d);
+	if (!(d & CPUID_SEP))
+		return __sysenter_ok = 0;
+	/* Pentium Pro 也置这一位，但它并不支持(family 6，model 和 stepping 都小于 3) */
+	if (((a >> 8) & 15) == 6 && ((a >> 4) & 15) < 3 && (a & 15) < 3)
+		return __sysenter_ok = 0;
+	return __sysenter_ok = 1;
+}
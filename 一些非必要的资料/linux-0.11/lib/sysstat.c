@@ -0,0 +1,9 @@
+/*
+ *  linux/lib/sysstat.c
+ */
+
+#define __LIBRARY__
+#include <unistd.h>
+#include <sys/sysstat.h>
+
+_syscall3(int,sysstat,int,cmd,struct sysstat *,buf,int,n)
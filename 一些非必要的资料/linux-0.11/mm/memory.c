@@ -27,6 +27,7 @@
 #include <linux/sched.h>
 #include <linux/head.h>
 #include <linux/kernel.h>
+#include <linux/trace.h>
 
 volatile void do_exit(long code);
 
@@ -311,6 +312,7 @@ void un_wp_page(unsigned long * table_entry)
 // 写共享页面时，需复制页面（写时复制）。
 void do_wp_page(unsigned long error_code,unsigned long address)
 {
+	trace(TRACE_PAGE_FAULT, address, error_code);
 #if 0
 /* we cannot do this yet: the estdio library writes to code space */
 /* stupid, stupid. I really want the libc.a from GNU */
@@ -481,6 +483,8 @@ void do_no_page(unsigned long error_code,unsigned long address)
 	unsigned long tmp;
 	unsigned long page;
 	int block,i;
+
+	trace(TRACE_PAGE_FAULT, address, error_code);
 	// 页面地址
 	address &= 0xfffff000;
 	// 临时地址长度
@@ -0,0 +1,62 @@
+/*
+ *  linux/tools/blkread.c
+ */
+
+/*
+ * Sequential read of a block device, for comparing the hd driver's
+ * bus-master DMA and PIO paths. Prints the rate and the system CPU
+ * spent per MB. Run it under the system twice: once on a machine with
+ * a PIIX controller (DMA, "hd: bus-master DMA at ..." at boot) and once
+ * without PCI (PIO), e.g.
+ *
+ *	qemu-system-i386 -machine pc ...	DMA
+ *	qemu-system-i386 -machine isapc ...	PIO
+ *	blkread [-k kbytes] [/dev/hd1]
+ *
+ * Read more than the buffer cache holds (the default 8 MB does), or the
+ * second run measures the cache.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/times.h>
+
+#ifndef HZ
+#define HZ 100
+#endif
+
+static char buf[8192];
+
+int main(int argc, char ** argv)
+{
+	char * name = "/dev/hd1";
+	long kbytes = 8192, got = 0, start, ticks, n;
+	struct tms t;
+	int i = 1, fd;
+
+	if (argc > 2 && argv[1][0] == '-' && argv[1][1] == 'k') {
+		kbytes = atol(argv[2]);
+		i = 3;
+	}
+	if (i < argc)
+		name = argv[i];
+	if ((fd = open(name, O_RDONLY)) < 0) {
+		perror(name);
+		return 1;
+	}
+	start = times(&t);
+	while (got < kbytes * 1024 && (n = read(fd, buf, sizeof(buf))) > 0)
+		got += n;
+	ticks = times(&t) - start;
+	if (ticks <= 0)
+		ticks = 1;
+	got /= 1024;
+	printf("%s: %ld kB in %ld.%02ld s, %ld kB/s\n", name, got,
+		ticks / HZ, (ticks % HZ) * 100 / HZ, got * HZ / ticks);
+	if (got >= 1024)
+		printf("system cpu %ld ticks, %ld ms per MB\n", (long) t.tms_stime,
+			(long) t.tms_stime * 1000 / HZ * 1024 / got);
+	return 0;
+}
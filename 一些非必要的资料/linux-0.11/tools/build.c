@@ -14,6 +14,13 @@
  * It does some checking that all files are of the correct type, and
  * just writes the result to stdout, removing headers and padding to
  * the right amount. It also writes some system data to stderr.
+ *
+ * The system may also be a compressed one (tools/zsystem, see
+ * boot/zhead.s): build doesn't care, but bootsect is told where the
+ * system ends so that it reads no more than needed. A plain system
+ * must end, bss included, below the setup parameters at 0x90000, as
+ * head.s clears the bss before main() reads them (tools/rdzip -s
+ * checks the same for the system inside a zsystem).
  */
 
 /*
@@ -33,6 +40,9 @@
 #define GCC_HEADER 1024
 
 #define SYS_SIZE 0x2000
+#define SYSSEG 0x1000		/* where bootsect loads the system */
+#define SYS_END 0x90000		/* setup.s puts the system parameters here */
+#define ZHIGH 0x100000		/* where a zsystem runs, see boot/zhead.s */
 
 #define DEFAULT_MAJOR_ROOT 3
 #define DEFAULT_MINOR_ROOT 6
@@ -60,6 +70,7 @@ int main(int argc, char ** argv)
 	char buf[1024];
 	char major_root, minor_root;
 	struct stat sb;
+	long sys_clicks;
 
 	if ((argc != 4) && (argc != 5))
 		usage();
@@ -86,6 +97,11 @@ int main(int argc, char ** argv)
 			major_root);
 		die("Bad root device --- major #");
 	}
+	if (stat(argv[3], &sb) || sb.st_size < GCC_HEADER)
+		die("Unable to stat 'system'");
+	sys_clicks = (sb.st_size - GCC_HEADER + 15) / 16;
+	if (sys_clicks > SYS_SIZE)
+		die("System is too big");
 	for (i=0;i<sizeof buf; i++) buf[i]=0;
 	if ((id=open(argv[1],O_RDONLY,0))<0)
 		die("Unable to open 'boot'");
@@ -109,6 +125,8 @@ int main(int argc, char ** argv)
 		die("Boot block must be exactly 512 bytes");
 	if ((*(unsigned short *)(buf+510)) != 0xAA55)
 		die("Boot block hasn't got boot flag (0xAA55)");
+	buf[502] = (char) (SYSSEG + sys_clicks);	/* endseg */
+	buf[503] = (char) ((SYSSEG + sys_clicks) >> 8);
 	buf[508] = (char) minor_root;
 	buf[509] = (char) major_root;	
 	i=write(1,buf,512);
@@ -155,7 +173,13 @@ int main(int argc, char ** argv)
 		die("Unable to open 'system'");
 	if (read(id,buf,GCC_HEADER) != GCC_HEADER)
 		die("Unable to read header of 'system'");
-	if (((long *) buf)[5] != 0)
+	if (((long *) buf)[5] == 0) {
+		c = ((long *) buf)[1] + ((long *) buf)[2] + ((long *) buf)[3];
+		if (c > SYS_END) {
+			fprintf(stderr,"System ends at 0x%x (bss included)\n",c);
+			die("System is too big: its bss would clear the setup data at 0x90000");
+		}
+	} else if (((long *) buf)[5] != ZHIGH)
 		die("Non-GCC header of 'system'");
 	for (i=0 ; (c=read(id,buf,sizeof buf))>0 ; i+=c )
 		if (write(1,buf,c)!=c)
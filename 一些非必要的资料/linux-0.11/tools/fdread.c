@@ -0,0 +1,59 @@
+/*
+ *  linux/tools/fdread.c
+ */
+
+/*
+ * Floppy read timing. Reads a floppy device 1 kB at a time from the
+ * start, the way the file system does, and prints the rate and the
+ * time per block. With the track buffer only the first block of each
+ * track waits for the disk. Run it under the system:
+ *
+ *	fdread [-k kbytes] [/dev/fd0]
+ *
+ * The default is the whole 1.44 MB disk; on root images without
+ * /dev/fd0 name the 1.44 MB node instead (/dev/PS0, major 2 minor 28).
+ * The buffer cache keeps what was read, so time it right after boot
+ * (or after reading more than the cache holds from another device),
+ * not twice in a row.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/times.h>
+
+#ifndef HZ
+#define HZ 100
+#endif
+
+int main(int argc, char ** argv)
+{
+	char * name = "/dev/fd0", buf[1024];
+	long kbytes = 1440, got = 0, start, ticks;
+	struct tms t;
+	int i = 1, fd;
+
+	if (argc > 2 && argv[1][0] == '-' && argv[1][1] == 'k') {
+		kbytes = atol(argv[2]);
+		i = 3;
+	}
+	if (i < argc)
+		name = argv[i];
+	if ((fd = open(name, O_RDONLY)) < 0) {
+		perror(name);
+		return 1;
+	}
+	start = times(&t);
+	while (got < kbytes && read(fd, buf, sizeof(buf)) == sizeof(buf))
+		got++;
+	ticks = times(&t) - start;
+	if (ticks <= 0)
+		ticks = 1;
+	printf("%s: %ld kB in %ld.%02ld s, %ld kB/s", name, got,
+		ticks / HZ, (ticks % HZ) * 100 / HZ, got * HZ / ticks);
+	if (got)
+		printf(", %ld ms per 1 kB block", ticks * 1000 / HZ / got);
+	printf("\n");
+	return 0;
+}
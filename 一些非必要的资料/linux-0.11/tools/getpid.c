@@ -0,0 +1,74 @@
+/*
+ *  linux/tools/getpid.c
+ */
+
+/*
+ * System call entry cost. Times getpid() made three ways: a bare
+ * int 0x80, a bare sysenter (as __SYSENTER in <unistd.h> does it, only
+ * when __sysenter_probe() finds the CPU has it, i.e. when the kernel
+ * has set it up) and the library getpid(). Prints ns per call. Run it
+ * under the system:
+ *
+ *	getpid [calls]
+ */
+
+#define __LIBRARY__
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/times.h>
+
+#ifndef HZ
+#define HZ 100
+#endif
+
+static long calls = 1000000;
+
+static void report(char * how, long ticks)
+{
+	long us;
+
+	if (ticks <= 0)
+		ticks = 1;
+	us = ticks * (1000000 / HZ);
+	/* ns per call, kept within 32 bits */
+	printf("%-10s %ld calls in %ld.%02ld s, %ld ns per call\n", how, calls,
+		ticks / HZ, (ticks % HZ) * 100 / HZ,
+		us / calls * 1000 + (us % calls) * 1000 / calls);
+}
+
+int main(int argc, char ** argv)
+{
+	struct tms t;
+	long i, start, res = 0;
+
+	if (argc > 1)
+		calls = atol(argv[1]);
+	if (calls <= 0)
+		return 1;
+
+	start = times(&t);
+	for (i = 0 ; i < calls ; i++)
+		__asm__ volatile ("int $0x80" : "=a" (res) : "0" (20L));
+	report("int 0x80", times(&t) - start);
+	if (res != getpid())
+		printf("int 0x80 returned %ld\n", res);
+
+#ifdef __SYSENTER
+	if (__sysenter_probe()) {
+		start = times(&t);
+		for (i = 0 ; i < calls ; i++)
+			__asm__ volatile (__SYSENTER : "=a" (res) : "0" (20L) : "si");
+		report("sysenter", times(&t) - start);
+		if (res != getpid())
+			printf("sysenter returned %ld\n", res);
+	} else
+		printf("sysenter   not supported by this CPU\n");
+#endif
+
+	start = times(&t);
+	for (i = 0 ; i < calls ; i++)
+		getpid();
+	report("getpid()", times(&t) - start);
+	return 0;
+}
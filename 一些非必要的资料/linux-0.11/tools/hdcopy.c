@@ -0,0 +1,70 @@
+/*
+ *  linux/tools/hdcopy.c
+ */
+
+/*
+ * Two-disk copy. Copies the start of one device to another in 8 kB
+ * blocks and prints the combined throughput (bytes read plus bytes
+ * written per second). With the hd requests of both drives overlapped,
+ * a copy from hd0 to hd1 should keep both drives busy. Run it under the
+ * system with two disks attached, on partitions that may be overwritten:
+ *
+ *	qemu-system-i386 ... -hda root.img -hdb scratch.img
+ *	hdcopy [-k kbytes] /dev/hd2 /dev/hd6
+ *
+ * The copy is timed up to and including the final sync(), so that
+ * every written block has reached the disk.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/times.h>
+
+#ifndef HZ
+#define HZ 100
+#endif
+
+static char buf[8192];
+
+int main(int argc, char ** argv)
+{
+	long kbytes = 4096, done = 0, start, ticks, n;
+	struct tms t;
+	int i = 1, in, out;
+
+	if (argc > 2 && argv[1][0] == '-' && argv[1][1] == 'k') {
+		kbytes = atol(argv[2]);
+		i = 3;
+	}
+	if (argc - i != 2) {
+		fprintf(stderr, "usage: hdcopy [-k kbytes] from to\n");
+		return 1;
+	}
+	if ((in = open(argv[i], O_RDONLY)) < 0) {
+		perror(argv[i]);
+		return 1;
+	}
+	if ((out = open(argv[i+1], O_WRONLY)) < 0) {
+		perror(argv[i+1]);
+		return 1;
+	}
+	start = times(&t);
+	while (done < kbytes * 1024 && (n = read(in, buf, sizeof(buf))) > 0) {
+		if (write(out, buf, n) != n) {
+			perror("write");
+			break;
+		}
+		done += n;
+	}
+	sync();
+	ticks = times(&t) - start;
+	if (ticks <= 0)
+		ticks = 1;
+	done /= 1024;
+	printf("%ld kB copied in %ld.%02ld s: %ld kB/s each way, %ld kB/s combined\n",
+		done, ticks / HZ, (ticks % HZ) * 100 / HZ,
+		done * HZ / ticks, 2 * done * HZ / ticks);
+	return 0;
+}
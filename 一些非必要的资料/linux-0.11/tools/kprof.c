@@ -0,0 +1,167 @@
+/*
+ *  linux/tools/kprof.c
+ */
+
+/*
+ * Turns the kernel profile (see kernel/prof.c and <sys/prof.h>) into a
+ * list of functions with the clock ticks spent in each, busiest first.
+ * The dump on stdin is pr_off and pr_scale followed by the counters, all
+ * 32-bit little-endian words, i.e. what a program in the guest gets from
+ *
+ *	n = prof(PROF_KREAD, &pr);
+ *	write(fd, &pr.pr_off, 8);
+ *	write(fd, pr.pr_base, n);
+ *
+ * The map is System.map; both "address symbol" link map lines and nm
+ * style "address type symbol" lines are understood.
+ *
+ *	tools/kprof System.map < kprof.dump
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+struct sym {
+	unsigned long addr;
+	char name[64];
+	unsigned long ticks;
+};
+
+static struct sym * syms = NULL;
+static int nsyms = 0, asyms = 0;
+
+void die(char * str)
+{
+	fprintf(stderr,"%s\n",str);
+	exit(1);
+}
+
+static unsigned long get_word(FILE * f, int * eof)
+{
+	unsigned char b[4];
+
+	if (fread(b,1,4,f) != 4) {
+		*eof = 1;
+		return 0;
+	}
+	return b[0] | (b[1] << 8) | ((unsigned long) b[2] << 16) |
+		((unsigned long) b[3] << 24);
+}
+
+static void add_sym(unsigned long addr, char * name)
+{
+	if (!isalpha((unsigned char) *name) && *name != '_')
+		return;
+	if (nsyms == asyms) {
+		asyms = asyms ? 2*asyms : 1024;
+		if (!(syms = realloc(syms, asyms * sizeof(*syms))))
+			die("Out of memory");
+	}
+	syms[nsyms].addr = addr;
+	strncpy(syms[nsyms].name, name, sizeof(syms[nsyms].name) - 1);
+	syms[nsyms].name[sizeof(syms[nsyms].name) - 1] = '\0';
+	syms[nsyms].ticks = 0;
+	nsyms++;
+}
+
+static void read_map(char * file)
+{
+	FILE * f;
+	char line[256], a[64], b[64], c[64];
+	char * end;
+	unsigned long addr;
+	int n;
+
+	if (!(f = fopen(file, "r")))
+		die("Unable to open map");
+	while (fgets(line, sizeof(line), f)) {
+		n = sscanf(line, "%63s %63s %63s", a, b, c);
+		if (n < 2)
+			continue;
+		addr = strtoul(a, &end, 16);
+		if (*end)
+			continue;
+		if (n == 3 && strlen(b) == 1)
+			add_sym(addr, c);	/* nm: address type symbol */
+		else if (n == 2)
+			add_sym(addr, b);	/* link map: address symbol */
+	}
+	fclose(f);
+}
+
+static int by_addr(const void * a, const void * b)
+{
+	const struct sym * x = a, * y = b;
+
+	return (x->addr > y->addr) - (x->addr < y->addr);
+}
+
+static int by_ticks(const void * a, const void * b)
+{
+	const struct sym * x = a, * y = b;
+
+	return (y->ticks > x->ticks) - (y->ticks < x->ticks);
+}
+
+/*
+ * The symbol a pc belongs to: the last one at or below it.
+ */
+static struct sym * lookup(unsigned long pc)
+{
+	int lo = 0, hi = nsyms - 1, mid;
+
+	if (!nsyms || pc < syms[0].addr)
+		return NULL;
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if (syms[mid].addr <= pc)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return syms + lo;
+}
+
+int main(int argc, char ** argv)
+{
+	unsigned long off, scale, count, total = 0, lost = 0, i;
+	struct sym * s;
+	int eof = 0;
+
+	if (argc != 2)
+		die("Usage: kprof System.map < dump");
+	read_map(argv[1]);
+	qsort(syms, nsyms, sizeof(*syms), by_addr);
+	off = get_word(stdin, &eof);
+	scale = get_word(stdin, &eof);
+	if (eof || !scale)
+		die("Bad profile dump");
+	for (i = 0 ; ; i++) {
+		count = get_word(stdin, &eof);
+		if (eof)
+			break;
+		if (!count)
+			continue;
+		total += count;
+		/* first pc that maps to counter i */
+		if ((s = lookup(off + (unsigned long)
+		    (((unsigned long long) i << 17) / scale))))
+			s->ticks += count;
+		else
+			lost += count;
+	}
+	if (!total)
+		die("No samples");
+	qsort(syms, nsyms, sizeof(*syms), by_ticks);
+	for (i = 0 ; i < nsyms && syms[i].ticks ; i++)
+		printf("%8lu %5.1f%%  %08lx %s\n", syms[i].ticks,
+			100.0 * syms[i].ticks / total, syms[i].addr,
+			syms[i].name);
+	if (lost)
+		printf("%8lu %5.1f%%  (below the first symbol)\n", lost,
+			100.0 * lost / total);
+	printf("%8lu total\n", total);
+	return 0;
+}
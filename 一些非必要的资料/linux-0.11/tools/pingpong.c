@@ -0,0 +1,57 @@
+/*
+ *  linux/tools/pingpong.c
+ */
+
+/*
+ * Context-switch rate. Two processes pass one byte back and forth over
+ * a pair of pipes; each one blocks until the other has written, so
+ * every round trip is two task switches. Prints the round trips and the
+ * switches per second. Run it under the system:
+ *
+ *	pingpong [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/times.h>
+#include <sys/wait.h>
+
+#ifndef HZ
+#define HZ 100
+#endif
+
+int main(int argc, char ** argv)
+{
+	long rounds = 100000, i, start, ticks;
+	int ping[2], pong[2];
+	struct tms t;
+	char c = 0;
+
+	if (argc > 1)
+		rounds = atol(argv[1]);
+	if (pipe(ping) < 0 || pipe(pong) < 0) {
+		perror("pipe");
+		return 1;
+	}
+	if (!fork()) {
+		for (i = 0 ; i < rounds ; i++)
+			if (read(ping[0], &c, 1) != 1 || write(pong[1], &c, 1) != 1)
+				_exit(1);
+		_exit(0);
+	}
+	start = times(&t);
+	for (i = 0 ; i < rounds ; i++)
+		if (write(ping[1], &c, 1) != 1 || read(pong[0], &c, 1) != 1) {
+			perror("pingpong");
+			break;
+		}
+	ticks = times(&t) - start;
+	wait(NULL);
+	if (ticks <= 0)
+		ticks = 1;
+	printf("%ld round trips in %ld.%02ld s: %ld switches/s, %ld us per switch\n",
+		i, ticks / HZ, (ticks % HZ) * 100 / HZ, 2 * i * HZ / ticks,
+		i ? ticks * (1000000 / HZ) / (2 * i) : 0L);
+	return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ *  linux/tools/pollloop.c
+ */
+
+/*
+ * A single-process event loop over several pipes, which is what
+ * select()/poll() and O_NONBLOCK make possible. N writer children
+ * each send M numbered messages down their own pipe; the parent
+ * waits for all of them with poll(), drains each ready pipe with
+ * non-blocking reads until EAGAIN, checks the sequence numbers and
+ * closes a pipe at EOF (which poll() reports with POLLHUP). It prints
+ * the message rate. Run it under the system (poll() is in lib/poll.c):
+ *
+ *	pollloop [writers [messages]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/poll.h>
+#include <sys/times.h>
+#include <sys/wait.h>
+
+#ifndef HZ
+#define HZ 100
+#endif
+
+#define MAX_WRITERS 16
+
+int main(int argc, char ** argv)
+{
+	struct pollfd fds[MAX_WRITERS];
+	long next[MAX_WRITERS], msg, got = 0, bad = 0, eagain = 0, loops = 0, hup = 0;
+	int writers = 8, open_fds, p[2], i, j, n;
+	long messages = 10000, start, ticks;
+	struct tms t;
+
+	if (argc > 1)
+		writers = atoi(argv[1]);
+	if (argc > 2)
+		messages = atol(argv[2]);
+	if (writers < 1 || writers > MAX_WRITERS) {
+		fprintf(stderr, "1 to %d writers\n", MAX_WRITERS);
+		return 1;
+	}
+	start = times(&t);
+	for (i = 0 ; i < writers ; i++) {
+		if (pipe(p) < 0) {
+			perror("pipe");
+			return 1;
+		}
+		if (!fork()) {
+			close(p[0]);
+			for (msg = 0 ; msg < messages ; msg++)
+				if (write(p[1], &msg, sizeof(msg)) != sizeof(msg))
+					_exit(1);
+			_exit(0);
+		}
+		close(p[1]);
+		fcntl(p[0], F_SETFL, O_NONBLOCK);
+		fds[i].fd = p[0];
+		fds[i].events = POLLIN;
+		next[i] = 0;
+	}
+	open_fds = writers;
+	while (open_fds) {
+		if (poll(fds, writers, -1) < 0) {
+			perror("poll");
+			return 1;
+		}
+		loops++;
+		for (i = 0 ; i < writers ; i++) {
+			if (fds[i].fd < 0 || !fds[i].revents)
+				continue;
+			/* drain it: the pipe may hold many messages */
+			while ((n = read(fds[i].fd, &msg, sizeof(msg))) == sizeof(msg)) {
+				if (msg != next[i]++)
+					bad++;
+				got++;
+			}
+			if (n < 0 && errno == EAGAIN)
+				eagain++;
+			/* EOF: the writer has finished and closed its end */
+			if (n == 0) {
+				if (fds[i].revents & POLLHUP)
+					hup++;
+				close(fds[i].fd);
+				fds[i].fd = -1;
+				open_fds--;
+			}
+		}
+	}
+	ticks = times(&t) - start;
+	for (j = 0 ; j < writers ; j++)
+		wait(NULL);
+	if (ticks <= 0)
+		ticks = 1;
+	printf("%d pipes, %ld messages in %ld.%02ld s: %ld messages/s\n",
+		writers, got, ticks / HZ, (ticks % HZ) * 100 / HZ, got * HZ / ticks);
+	printf("%ld poll() calls, %ld reads ended with EAGAIN, %ld EOFs seen with POLLHUP\n",
+		loops, eagain, hup);
+	printf("%ld out of order, %ld missing\n", bad, writers * messages - got);
+	return bad || got != writers * messages;
+}
@@ -0,0 +1,235 @@
+/*
+ *  linux/tools/rdzip.c
+ */
+
+/*
+ * Compresses a root file system image for rd_load(): reads the image
+ * on stdin and writes an rdz_header followed by the LZSS stream (see
+ * include/linux/lzss.h) on stdout. The result goes on the boot floppy
+ * at block 256, where the uncompressed image used to go.
+ *
+ *	tools/rdzip < rootimage > rootimage.z
+ *
+ * With -s the input is tools/system itself and the result is written
+ * as assembler source defining _input_data, which is how the compressed
+ * kernel (zImage) gets the system linked into its decompressor, see
+ * boot/unzip.c. The a.out header is stripped, and the system is checked
+ * to end, bss included, below the setup parameters at 0x90000: head.s
+ * clears the bss before main() reads them.
+ *
+ *	tools/rdzip -s < tools/system > boot/zpiggy.s
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/linux/lzss.h"
+
+#define GCC_HEADER	1024
+#define SYS_END		0x90000	/* setup.s puts the system parameters here */
+
+#define HASH_SIZE	4096
+#define MAX_CHAIN	256
+
+static unsigned char * in;
+static long in_size;
+static long head[HASH_SIZE];
+static long * prev;
+
+static unsigned char out_buf[1 + 8*2];
+static int out_len, out_bit;
+static unsigned char * zbuf = NULL;
+static long zsize = 0, zalloc = 0;
+
+void die(char * str)
+{
+	fprintf(stderr,"%s\n",str);
+	exit(1);
+}
+
+/*
+ * The header is three 32-bit little-endian words as the kernel sees
+ * struct rdz_header; store it byte by byte so any host will do.
+ */
+static void put_header(unsigned char * p, unsigned long size,
+	unsigned long zsize)
+{
+	unsigned long w[3];
+	int i;
+
+	w[0] = RDZ_MAGIC;
+	w[1] = size;
+	w[2] = zsize;
+	for (i = 0 ; i < 12 ; i++)
+		p[i] = (w[i/4] >> (8*(i%4))) & 0xff;
+}
+
+static void write_binary(long size)
+{
+	unsigned char h[12];
+
+	put_header(h, size, zsize);
+	if (fwrite(h,1,12,stdout) != 12 ||
+	    fwrite(zbuf,1,zsize,stdout) != zsize)
+		die("Write error");
+}
+
+static void write_source(long size)
+{
+	unsigned char h[12];
+	long i;
+
+	put_header(h, size, zsize);
+	printf("/*\n * Generated by tools/rdzip -s: do not edit.\n */\n");
+	printf(".data\n.globl _input_data\n_input_data:\n");
+	for (i = 0 ; i < 12 + zsize ; i++)
+		printf("%s%d%s", (i % 16) ? "" : "\t.byte ",
+			(i < 12) ? h[i] : zbuf[i-12],
+			(i % 16 == 15 || i == 11 + zsize) ? "\n" : ",");
+	if (ferror(stdout))
+		die("Write error");
+}
+
+/* a 32-bit little-endian word of the a.out header */
+static unsigned long header_word(int n)
+{
+	unsigned char * p = in + 4*n;
+
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned long) p[3] << 24);
+}
+
+/*
+ * Strip the a.out header of the system and check that it ends, bss
+ * included, below SYS_END.
+ */
+static void strip_system(void)
+{
+	unsigned long text, data, bss;
+
+	if (in_size < GCC_HEADER)
+		die("Unable to read header of 'system'");
+	text = header_word(1);
+	data = header_word(2);
+	bss = header_word(3);
+	if (header_word(5) != 0)
+		die("Non-GCC header of 'system'");
+	if (text + data + bss > SYS_END) {
+		fprintf(stderr, "System ends at 0x%lx (bss included)\n",
+			text + data + bss);
+		die("System is too big: its bss would clear the setup data at 0x90000");
+	}
+	in_size -= GCC_HEADER;
+	memmove(in, in + GCC_HEADER, in_size);
+}
+
+static int hash(long pos)
+{
+	return ((in[pos] << 8) ^ (in[pos+1] << 4) ^ in[pos+2]) & (HASH_SIZE-1);
+}
+
+static void flush_items(void)
+{
+	if (zsize + out_len > zalloc &&
+	    !(zbuf = realloc(zbuf, zalloc += 65536)))
+		die("Out of memory");
+	memcpy(zbuf + zsize, out_buf, out_len);
+	zsize += out_len;
+	out_buf[0] = 0;
+	out_len = 1;
+	out_bit = 0;
+}
+
+static void put_item(int literal, int a, int b)
+{
+	if (out_bit == 8)
+		flush_items();
+	if (literal) {
+		out_buf[0] |= 1 << out_bit;
+		out_buf[out_len++] = a;
+	} else {
+		out_buf[out_len++] = a;
+		out_buf[out_len++] = b;
+	}
+	out_bit++;
+}
+
+static void insert(long pos)
+{
+	int h;
+
+	if (pos + LZSS_MIN_MATCH > in_size)
+		return;
+	h = hash(pos);
+	prev[pos] = head[h];
+	head[h] = pos;
+}
+
+int main(int argc, char ** argv)
+{
+	long pos, cand, best_len, best_dist, len, alloc = 0;
+	int chain, n, source = 0;
+
+	if (argc == 2 && !strcmp(argv[1], "-s"))
+		source = 1;
+	else if (argc != 1)
+		die("Usage: rdzip [-s] < image > image.z");
+	in = NULL;
+	in_size = 0;
+	do {
+		if (in_size == alloc && !(in = realloc(in, alloc += 65536)))
+			die("Out of memory");
+		in_size += n = fread(in + in_size, 1, alloc - in_size, stdin);
+	} while (n > 0);
+	if (source)
+		strip_system();
+	if (!(prev = malloc((in_size + 1) * sizeof(long))))
+		die("Out of memory");
+	for (n = 0 ; n < HASH_SIZE ; n++)
+		head[n] = -1;
+	out_buf[0] = 0;
+	out_len = 1;
+	out_bit = 0;
+	for (pos = 0 ; pos < in_size ; ) {
+		best_len = 0;
+		best_dist = 0;
+		if (pos + LZSS_MIN_MATCH <= in_size) {
+			cand = head[hash(pos)];
+			for (chain = 0 ; cand >= 0 && chain < MAX_CHAIN ; chain++) {
+				if (pos - cand > LZSS_WINDOW)
+					break;
+				for (len = 0 ; len < LZSS_MAX_MATCH &&
+				     pos + len < in_size &&
+				     in[cand+len] == in[pos+len] ; len++)
+					/* nothing */ ;
+				if (len > best_len) {
+					best_len = len;
+					best_dist = pos - cand;
+					if (len == LZSS_MAX_MATCH)
+						break;
+				}
+				cand = prev[cand];
+			}
+		}
+		if (best_len >= LZSS_MIN_MATCH) {
+			put_item(0, (best_dist-1) & 0xff,
+				(((best_dist-1) >> 4) & 0xf0) |
+				(best_len - LZSS_MIN_MATCH));
+			while (best_len--)
+				insert(pos++);
+		} else {
+			put_item(1, in[pos], 0);
+			insert(pos++);
+		}
+	}
+	if (out_bit)
+		flush_items();
+	if (source)
+		write_source(in_size);
+	else
+		write_binary(in_size);
+	if (fflush(stdout))
+		die("Write error");
+	fprintf(stderr,"%s is %ld bytes, %ld compressed\n",
+		source ? "System" : "Ram disk image", in_size, zsize);
+	return 0;
+}
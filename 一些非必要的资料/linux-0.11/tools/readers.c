@@ -0,0 +1,76 @@
+/*
+ *  linux/tools/readers.c
+ */
+
+/*
+ * Many readers of the same blocks. N children are started together and
+ * each reads the same region of a device 1 kB at a time, so they all
+ * wait on the same buffer while it is being read in. This is what the
+ * wait queues (include/linux/wait.h) change: every waiter of a buffer
+ * is woken at once instead of one after the other. Prints the elapsed
+ * time and the system CPU. Run it under the system:
+ *
+ *	readers [-n readers] [-k kbytes] [/dev/hd1]
+ *
+ * The region should be larger than the buffer cache (the default 8 MB
+ * is), so that it is read from the disk again on every run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/times.h>
+#include <sys/wait.h>
+
+#ifndef HZ
+#define HZ 100
+#endif
+
+int main(int argc, char ** argv)
+{
+	char * name = "/dev/hd1", buf[1024];
+	long kbytes = 8192, start, ticks, k;
+	int readers = 8, i, fd, go[2], failed = 0, status;
+	struct tms t;
+
+	for (i = 1 ; i < argc - 1 && argv[i][0] == '-' ; i += 2)
+		if (argv[i][1] == 'n')
+			readers = atoi(argv[i+1]);
+		else if (argv[i][1] == 'k')
+			kbytes = atol(argv[i+1]);
+	if (i < argc)
+		name = argv[i];
+	if (pipe(go) < 0) {
+		perror("pipe");
+		return 1;
+	}
+	for (i = 0 ; i < readers ; i++)
+		if (!fork()) {
+			close(go[1]);
+			if ((fd = open(name, O_RDONLY)) < 0)
+				_exit(1);
+			/* wait for the parent to start everyone together */
+			read(go[0], buf, 1);
+			for (k = 0 ; k < kbytes ; k++)
+				if (read(fd, buf, sizeof(buf)) != sizeof(buf))
+					_exit(1);
+			_exit(0);
+		}
+	close(go[0]);
+	sleep(1);
+	start = times(&t);
+	close(go[1]);
+	for (i = 0 ; i < readers ; i++)
+		if (wait(&status) < 0 || status)
+			failed++;
+	ticks = times(&t) - start;
+	if (ticks <= 0)
+		ticks = 1;
+	printf("%d readers x %ld kB of %s in %ld.%02ld s, %ld kB/s each\n",
+		readers, kbytes, name, ticks / HZ, (ticks % HZ) * 100 / HZ,
+		kbytes * HZ / ticks);
+	printf("system cpu %ld ticks, user %ld ticks, %d readers failed\n",
+		(long) t.tms_cstime, (long) t.tms_cutime, failed);
+	return failed != 0;
+}
@@ -0,0 +1,123 @@
+/*
+ *  linux/tools/rsloop.c
+ */
+
+/*
+ * Serial loopback throughput. A child writes a counting byte pattern
+ * to one serial line while the parent reads it back from another (or
+ * the same) line in raw mode, then prints the rate, the bytes lost or
+ * corrupted, and the CPU time both used. Run it under the system,
+ * with the port looped back by the emulator, e.g. for COM1 onto itself:
+ *
+ *	qemu-system-i386 ... -serial udp::4555@127.0.0.1:4555
+ *	rsloop [-b 115200] [-k kbytes] [/dev/tty1 [/dev/tty1]]
+ *
+ * Reading stops when a second passes without data (VTIME), so lost
+ * bytes show up as a short count rather than a hang.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <termios.h>
+#include <sys/times.h>
+#include <sys/wait.h>
+
+#ifndef HZ
+#define HZ 100
+#endif
+
+static struct {
+	long baud;
+	int bits;
+} speeds[] = {
+	{ 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 },
+#ifdef B57600
+	{ 57600, B57600 }, { 115200, B115200 },
+#endif
+	{ 0, 0 }
+};
+
+static int set_raw(int fd, int speed, struct termios * old)
+{
+	struct termios t;
+
+	if (tcgetattr(fd, old) < 0)
+		return -1;
+	t = *old;
+	t.c_iflag = 0;
+	t.c_oflag = 0;
+	t.c_lflag = 0;
+	t.c_cflag = (t.c_cflag & ~CBAUD) | speed | CS8 | CREAD | CLOCAL;
+	t.c_cc[VMIN] = 0;
+	t.c_cc[VTIME] = 10;
+	return tcsetattr(fd, TCSANOW, &t);
+}
+
+int main(int argc, char ** argv)
+{
+	char * out = "/dev/tty1", * in = NULL;
+	long baud = 115200, kbytes = 64, total, got = 0, bad = 0, n, i, start, ticks;
+	struct termios old_out, old_in;
+	struct tms t;
+	char buf[1024];
+	int ofd, ifd, speed = 0, pid;
+
+	for (i = 1 ; i < argc - 1 && argv[i][0] == '-' ; i += 2)
+		if (argv[i][1] == 'b')
+			baud = atol(argv[i+1]);
+		else if (argv[i][1] == 'k')
+			kbytes = atol(argv[i+1]);
+	if (i < argc)
+		out = argv[i++];
+	in = (i < argc) ? argv[i] : out;
+	for (i = 0 ; speeds[i].baud ; i++)
+		if (speeds[i].baud == baud)
+			speed = speeds[i].bits;
+	if (!speed) {
+		fprintf(stderr, "unsupported speed %ld\n", baud);
+		return 1;
+	}
+	if ((ofd = open(out, O_RDWR)) < 0 || (ifd = open(in, O_RDWR)) < 0) {
+		perror("open");
+		return 1;
+	}
+	if (set_raw(ofd, speed, &old_out) < 0 || set_raw(ifd, speed, &old_in) < 0) {
+		perror("tcsetattr");
+		return 1;
+	}
+	total = kbytes * 1024;
+	start = times(&t);
+	if (!(pid = fork())) {
+		for (n = 0 ; n < total ; n += i) {
+			for (i = 0 ; i < sizeof(buf) && n + i < total ; i++)
+				buf[i] = (n + i) & 0xff;
+			if (write(ofd, buf, i) != i)
+				_exit(1);
+		}
+		_exit(0);
+	}
+	while (got < total && (n = read(ifd, buf, sizeof(buf))) > 0)
+		for (i = 0 ; i < n ; i++, got++)
+			if ((buf[i] & 0xff) != (got & 0xff))
+				bad++;
+	ticks = times(&t) - start;
+	kill(pid, SIGKILL);
+	wait(NULL);
+	times(&t);
+	tcsetattr(ofd, TCSANOW, &old_out);
+	tcsetattr(ifd, TCSANOW, &old_in);
+	if (ticks <= 0)
+		ticks = 1;
+	printf("%ld baud: %ld of %ld bytes in %ld.%02ld s, %ld bytes/s\n",
+		baud, got, total, ticks / HZ, (ticks % HZ) * 100 / HZ,
+		got * HZ / ticks);
+	printf("lost %ld, out of sequence %ld, cpu %ld%% (user %ld, system %ld ticks)\n",
+		total - got, bad,
+		(long) (t.tms_utime + t.tms_stime + t.tms_cutime + t.tms_cstime) * 100 / ticks,
+		(long) (t.tms_utime + t.tms_cutime), (long) (t.tms_stime + t.tms_cstime));
+	return 0;
+}
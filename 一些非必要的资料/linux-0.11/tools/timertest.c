@@ -0,0 +1,178 @@
+/*
+ *  linux/tools/timertest.c
+ */
+
+/*
+ * Tests the timer wheel (kernel/timer.c) on the host. The kernel file is
+ * compiled in as it is, with cli()/sti() made no-ops and jiffies,
+ * get_free_page() and panic() supplied here. Thousands of timers are
+ * armed at random distances (from 0 to past the top level), some are
+ * re-armed or cancelled, and jiffies is stepped one tick at a time the
+ * way do_timer() does. Each timer must fire exactly once, at its expiry
+ * tick, and cancelled ones never; no timer may fire before the tick
+ * that next_timer_jiffies() said was the next one due. Prints the time
+ * spent.
+ *
+ *	tools/timertest [timers [ticks]]
+ *
+ * It is built with -nostdinc -Iinclude like the kernel, so no host
+ * header is used and the few library functions are declared here.
+ * <asm/system.h> is included first so that the no-op cli()/sti()
+ * below replace its definitions for timer.c.
+ */
+
+#include <asm/system.h>
+
+#undef cli
+#undef sti
+#undef save_flags
+#undef restore_flags
+#define cli()
+#define sti()
+#define save_flags(x)	((void) (x))
+#define restore_flags(x)
+
+#include "../kernel/timer.c"
+
+extern int printf(const char * fmt, ...);
+extern void exit(int status);
+extern long clock(void);
+extern int atoi(const char * s);
+
+#define CLOCKS_PER_SEC	1000000
+
+long volatile jiffies = 0;
+
+unsigned long get_free_page(void)
+{
+	return (unsigned long) malloc(PAGE_SIZE);
+}
+
+volatile void panic(const char * s)
+{
+	printf("panic: %s\n", s);
+	exit(1);
+}
+
+struct test_timer {
+	struct timer_list timer;
+	unsigned long expires;
+	int pending;			/* armed and not yet fired */
+	int fired;
+};
+
+static struct test_timer * timers;
+static long errors = 0, fired = 0, old_fired = 0;
+static unsigned long quiet_until = 0;	/* from next_timer_jiffies() */
+static unsigned long seed = 1;
+
+static unsigned long rnd(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 8) & 0xffffff;
+}
+
+/* from 0 ticks to beyond the 2^26 ticks that tv1-tv4 cover */
+static unsigned long rnd_delay(void)
+{
+	switch (rnd() & 7) {
+		case 0: return 0;
+		case 1: case 2: return rnd() & TVR_MASK;
+		case 3: case 4: return rnd() & ((1 << (TVR_BITS + TVN_BITS)) - 1);
+		case 5: return rnd() & ((1 << (TVR_BITS + 2 * TVN_BITS)) - 1);
+		case 6: return rnd();
+		default: return rnd() << 4;
+	}
+}
+
+static void fire(unsigned long data)
+{
+	struct test_timer * t = timers + data;
+
+	if (t->fired || !t->pending || t->expires != (unsigned long) jiffies) {
+		printf("timer %lu: fired at %ld, expires %lu, fired before %d\n",
+			data, jiffies, t->expires, t->fired);
+		errors++;
+	}
+	if ((unsigned long) jiffies < quiet_until) {
+		printf("timer %lu: fired at %ld, next_timer_jiffies() said %lu\n",
+			data, jiffies, quiet_until);
+		errors++;
+	}
+	t->fired = 1;
+	t->pending = 0;
+	fired++;
+}
+
+static void old_fn(void)
+{
+	old_fired++;
+}
+
+static void arm(long i)
+{
+	timers[i].expires = jiffies + rnd_delay();
+	timers[i].pending = 1;
+	timers[i].fired = 0;
+	mod_timer(&timers[i].timer, timers[i].expires);
+}
+
+int main(int argc, char ** argv)
+{
+	long n = 10000, ticks = 1 << 20, i, armed = 0, cancelled = 0, old = 0;
+	long start;
+	unsigned long next;
+
+	if (argc > 1)
+		n = atoi(argv[1]);
+	if (argc > 2)
+		ticks = atoi(argv[2]);
+	if (!(timers = malloc(n * sizeof(struct test_timer))))
+		return 1;
+	for (i = 0 ; i < n ; i++) {
+		init_timer(&timers[i].timer, fire, i);
+		arm(i);
+		armed++;
+	}
+	start = clock();
+	for (i = 0 ; i < ticks ; i++) {
+		/* some churn: re-arm, cancel, or use the old interface */
+		switch (rnd() & 15) {
+			case 0:
+				arm(rnd() % n);
+				armed++;
+				quiet_until = 0;
+				break;
+			case 1:
+				next = rnd() % n;
+				if (del_timer(&timers[next].timer) != timers[next].pending) {
+					printf("timer %lu: del_timer() got it wrong\n", next);
+					errors++;
+				}
+				timers[next].pending = 0;
+				cancelled++;
+				break;
+			case 2:
+				add_timer(rnd() & 1023, old_fn);
+				old++;
+				quiet_until = 0;
+				break;
+		}
+		run_timers();
+		/* as do_timer() asks it when the machine is idle */
+		quiet_until = next_timer_jiffies(64);
+		jiffies++;
+	}
+	for (i = 0 ; i < n ; i++)
+		if (timers[i].pending && timers[i].expires < (unsigned long) jiffies) {
+			printf("timer %ld: expires %lu, never fired\n", i, timers[i].expires);
+			errors++;
+		}
+	printf("%ld timers, %ld ticks: %ld armed, %ld cancelled, %ld fired, %ld errors\n",
+		n, ticks, armed, cancelled, fired, errors);
+	printf("add_timer(): %ld requested, %ld called\n", old, old_fired);
+	start = clock() - start;
+	printf("%ld ms, %ld ns per tick\n", start * 1000 / CLOCKS_PER_SEC,
+		start * (1000000000 / CLOCKS_PER_SEC) / ticks);
+	return errors != 0;
+}
@@ -0,0 +1,153 @@
+/*
+ *  linux/tools/tracedump.c
+ */
+
+/*
+ * Decodes kernel trace records (see include/linux/trace.h) into one line
+ * per event. The input is either what was read from /dev/trace, or with
+ * -s a capture of the serial port, where each record is a line "@T "
+ * followed by its 16 bytes in hex; other lines are skipped. Syscall exits
+ * show the time since the matching enter of the same pid.
+ *
+ *	tools/tracedump < trace.bin
+ *	tools/tracedump -s < serial.log
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REC_SIZE	16
+
+/* keep in step with include/linux/trace.h */
+static char * names[] = {
+	"lost", "switch", "wakeup", "blk_queue", "blk_start", "blk_done",
+	"page_fault", "sys_enter", "sys_exit", "buf_hit", "buf_miss"
+};
+
+#define NR_NAMES (sizeof(names) / sizeof(names[0]))
+
+#define TRACE_SYS_ENTER	7
+#define TRACE_SYS_EXIT	8
+
+static struct {
+	int pid;
+	unsigned long long time;
+	unsigned long nr;
+} enter[256];
+
+static unsigned long last_time = 0;
+static unsigned long long wraps = 0;
+
+void die(char * str)
+{
+	fprintf(stderr,"%s\n",str);
+	exit(1);
+}
+
+static unsigned long word(unsigned char * p)
+{
+	return p[0] | (p[1] << 8) | ((unsigned long) p[2] << 16) |
+		((unsigned long) p[3] << 24);
+}
+
+static void decode(unsigned char * r)
+{
+	unsigned long t = word(r), a = word(r + 8), b = word(r + 12);
+	int event = r[4] | (r[5] << 8), pid = r[6] | (r[7] << 8);
+	unsigned long long time;
+
+	/* the kernel's microsecond clock is 32 bits wide */
+	if (t < last_time && last_time - t > 0x80000000UL)
+		wraps += 0x100000000ULL;
+	last_time = t;
+	time = wraps + t;
+	printf("%6llu.%06llu %5d ", time / 1000000, time % 1000000, pid);
+	if (event >= NR_NAMES) {
+		printf("event %d %08lx %08lx\n", event, a, b);
+		return;
+	}
+	printf("%-10s ", names[event]);
+	switch (event) {
+		case 0:
+			printf("%lu records\n", a);
+			break;
+		case 1:
+			printf("%lu -> %lu\n", a, b);
+			break;
+		case 2:
+			printf("pid %lu\n", a);
+			break;
+		case 3: case 4:
+			printf("dev %04lx sector %lu\n", a, b);
+			break;
+		case 5:
+			printf("dev %04lx sector %lu%s\n", a & 0xffff, b,
+				(a >> 16) ? "" : " ERROR");
+			break;
+		case 6:
+			printf("address %08lx error %lx\n", a, b);
+			break;
+		case TRACE_SYS_ENTER:
+			enter[pid & 255].pid = pid;
+			enter[pid & 255].time = time;
+			enter[pid & 255].nr = a;
+			printf("nr %lu arg %08lx\n", a, b);
+			break;
+		case TRACE_SYS_EXIT:
+			printf("ret %ld", (long) (int) a);
+			if (enter[pid & 255].pid == pid && enter[pid & 255].time)
+				printf(" (nr %lu, %llu us)", enter[pid & 255].nr,
+					time - enter[pid & 255].time);
+			enter[pid & 255].time = 0;
+			printf("\n");
+			break;
+		default:
+			printf("dev %04lx block %lu\n", a, b);
+	}
+}
+
+static int hexval(int c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+static void read_serial(void)
+{
+	char line[256], * p;
+	unsigned char r[REC_SIZE];
+	int i, h, l;
+
+	while (fgets(line, sizeof(line), stdin)) {
+		if (!(p = strstr(line, "@T ")))
+			continue;
+		p += 3;
+		for (i = 0 ; i < REC_SIZE ; i++, p += 2) {
+			if ((h = hexval(p[0])) < 0 || (l = hexval(p[1])) < 0)
+				break;
+			r[i] = (h << 4) | l;
+		}
+		if (i == REC_SIZE)
+			decode(r);
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	unsigned char r[REC_SIZE];
+
+	if (argc == 2 && !strcmp(argv[1], "-s"))
+		read_serial();
+	else if (argc == 1)
+		while (fread(r, 1, REC_SIZE, stdin) == REC_SIZE)
+			decode(r);
+	else
+		die("Usage: tracedump [-s] < trace");
+	return 0;
+}
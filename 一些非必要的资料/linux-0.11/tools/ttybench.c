@@ -0,0 +1,94 @@
+/*
+ *  linux/tools/ttybench.c
+ */
+
+/*
+ * Terminal output throughput. Writes 1 MB (or the given number of kB)
+ * to each named terminal in 4 kB writes and prints the rate. Without
+ * arguments the console and the first serial line are used. Run it
+ * under the system itself:
+ *
+ *	gcc -o ttybench ttybench.c
+ *	ttybench [-k kbytes] [/dev/tty0 /dev/tty1 ...]
+ *
+ * The serial line is written with OPOST cleared, so the bulk path of
+ * tty_write() is the one measured; the console keeps its settings, as
+ * con_write() has its own fast path for plain text.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/times.h>
+
+#ifndef HZ
+#define HZ 100
+#endif
+
+#define CHUNK 4096
+
+static char buf[CHUNK];
+
+static void bench(char * name, long kbytes)
+{
+	struct termios old, raw;
+	struct tms t;
+	long start, ticks, left, n;
+	int fd, have_termios;
+
+	if ((fd = open(name, O_WRONLY)) < 0) {
+		perror(name);
+		return;
+	}
+	have_termios = (tcgetattr(fd, &old) == 0);
+	if (have_termios && strcmp(name, "/dev/tty0")) {
+		raw = old;
+		raw.c_oflag &= ~OPOST;
+		tcsetattr(fd, TCSANOW, &raw);
+	}
+	left = kbytes * 1024;
+	start = times(&t);
+	while (left > 0) {
+		n = (left < CHUNK) ? left : CHUNK;
+		if ((n = write(fd, buf, n)) <= 0) {
+			perror("write");
+			break;
+		}
+		left -= n;
+	}
+	ticks = times(&t) - start;
+	if (have_termios)
+		tcsetattr(fd, TCSADRAIN, &old);
+	close(fd);
+	if (ticks <= 0)
+		ticks = 1;
+	fprintf(stderr, "%s: %ld kB in %ld.%02ld s, %ld kB/s\n", name,
+		kbytes - left / 1024, ticks / HZ, (ticks % HZ) * 100 / HZ,
+		(kbytes - left / 1024) * HZ / ticks);
+}
+
+int main(int argc, char ** argv)
+{
+	long kbytes = 1024;
+	int i;
+
+	/* printable text with a newline every 80 characters */
+	for (i = 0 ; i < CHUNK ; i++)
+		buf[i] = (i % 80 == 79) ? '\n' : 'a' + i % 26;
+	i = 1;
+	if (argc > 2 && !strcmp(argv[1], "-k")) {
+		kbytes = atol(argv[2]);
+		i = 3;
+	}
+	if (i >= argc) {
+		bench("/dev/tty0", kbytes);
+		bench("/dev/tty1", kbytes);
+		return 0;
+	}
+	for ( ; i < argc ; i++)
+		bench(argv[i], kbytes);
+	return 0;
+}